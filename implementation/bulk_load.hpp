@@ -0,0 +1,48 @@
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+namespace bulk {
+    //tower layout of a perfectly balanced skiplist over n sorted elements, used by the bulk load constructors
+    //element i (counted from 1, head is 0) reaches level l iff base^l divides i, base = 1/p rounded
+    //the successor of i on level l is i + base^l, or n + 1 for the tail, so every link is known without a pass
+    class Layout {
+    public:
+        Layout(const double &p, const int &max_level, size_t n) : _n(n), _max_level(max_level) {
+            size_t base = 2;
+            if(p > 0 && p < 1) {
+                base = std::max<size_t>(2, std::lround(1 / p));
+            }
+            _pow.push_back(1);
+            for(int l = 1; l <= _max_level; ++l) {
+                //saturates above n, no element index is divisible by it
+                size_t next = _pow.back() > _n ? _pow.back() : _pow.back() * base;
+                _pow.push_back(next);
+            }
+            _top = 1;
+            while(_top < _max_level && _pow[_top] <= _n) _top++;
+        }
+
+        int level(size_t i) const {
+            int level = 1;
+            while(level < _max_level && i % _pow[level] == 0) level++;
+            return level;
+        }
+
+        size_t next(size_t i, int l) const {
+            return _pow[l] > _n - i ? _n + 1 : i + _pow[l];
+        }
+
+        //highest level used by an element, at least 1
+        int top() const { return _top; }
+
+    private:
+        const size_t _n;
+        const int _max_level;
+        int _top;
+        std::vector<size_t> _pow; //base^l, saturated above n
+    };
+}
@@ -1,50 +1,80 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <cstddef>
+#include <algorithm>
 #include <limits>
 #include <iostream>
 #include <atomic>
 #include <queue>
+#include <new>
+#include <cmath>
 
 #include "implementation/spinlock.hpp"
+#include "implementation/reclamation.hpp"
+#include "implementation/node_pool.hpp"
+#include "implementation/bulk_load.hpp"
 #include "random_generator.hpp"
 
 
-//must call method that updates all changed lengths
-template <class Key, class Value>
+//must call method that updates all changed lengths, MaxLevel bounds the max_level given at runtime
+//with live_index writers keep all lengths exact, rank and element_at need no compute_indices
+template <class Key, class Value, template<class> class Reclaimer = reclamation::GarbageQueues, int MaxLevel = 64, bool live_index = false, class NodeLock = lock::Spinlock>
 class IndexableLockSkipList
 {
 private:
+    struct Node;
     using Level = int;
     using Length = int;
-    using Lock = lock::Spinlock;
-    using QueueLock = lock::Spinlock;
+    using Lock = NodeLock;
 
-    struct Node {
+    using Reclaim = Reclaimer<Node>;
+    using Guard = typename Reclaim::Guard;
+    using NodeArray = std::array<Node*, MaxLevel>; //preds and succs live on the stack
+
+    //next and length towers are stored inline behind the node, one cache line aligned block per node from the node pool
+    struct alignas(64) Node {
         Node(Key k, Value val, Level lev) : 
-         key(k), value(val), level(lev), lock(),
-         beeing_deleted(false), fully_linked(false) {
-            next = new std::atomic<Node*>[level];
-            length = new std::atomic<Length>[level];
+         level(lev), lock(), beeing_deleted(false), fully_linked(false),
+         value(val), key(k) {
+            length = reinterpret_cast<std::atomic<Length>*>(next + level);
+            for(Level i = 0; i < level; ++i) {
+                new (&next[i]) std::atomic<Node*>(nullptr);
+                new (&length[i]) std::atomic<Length>(0);
+            }
          };
-        ~Node() {
-            delete next;
-            delete length;
+        //the block ends with the towers, the padding of the aligned struct is not allocated
+        static void* operator new(size_t, Level lev) {
+            size_t tower = lev * (sizeof(std::atomic<Node*>) + sizeof(std::atomic<Length>));
+            return pool::NodePool<Node>::allocate(offsetof(Node, next) + tower, lev);
         }
-        std::atomic<Key> key;
-        std::atomic<Value> value;
-        std::atomic<Node*> *next;
-        std::atomic<Length> *length;
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level;
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+
+        std::atomic<Length> *length; //points behind next[level - 1]
         Level level;
         Lock lock;
         std::atomic<bool> beeing_deleted; //some threads currently deletes this node
         std::atomic<bool> fully_linked; //all pointers are set
+        std::atomic<unsigned> version{0}; //odd while a live index writer changes next or length, readers retry
+        lock::SharedGate span; //shared by live index writers adjusting the lengths, closed by the one changing the spans
+        std::atomic<bool> dirty{true}; //segment behind this node changed since the last incremental compute
+        std::atomic<Value> value;
+        std::atomic<Key> key; //next to next[0], read together on every hop
+        std::atomic<Node*> next[];
     };
 
 public:
-    IndexableLockSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
-        _head = new Node(_min_key, Value(), _max_level);
-        _tail = new Node(_max_key, Value(), _max_level);
+    IndexableLockSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level),
+     _segment_level(segment_level(probability, _max_level)), _reclaimer(_max_level) {
+        _head = new (_max_level) Node(_min_key, Value(), _max_level);
+        _tail = new (_max_level) Node(_max_key, Value(), _max_level);
         for(int i = 0; i < _max_level; ++i) {
             _head -> next[i] = _tail;
             _head -> length[i] = 1;
@@ -53,81 +83,59 @@ public:
             _tail -> next[i] = _tail; //safety
             _tail -> length[i] = 0;
         }
-        _queue_locks = new QueueLock[_num_queues];
     };
 
-    ~IndexableLockSkipList() {
-        for(auto &q : _queues) {
-            while(!q.empty()) {
-                auto ptr = q.front(); q.pop();
-                delete ptr;
-            }
-        }
-        delete _queue_locks;
+    //bulk load from a random access range of (key, value) pairs sorted by unique keys, O(n) and parallel with OpenMP
+    template<class Iterator>
+    IndexableLockSkipList(const double &probability, const Level &max_level, Iterator first, Iterator last) : IndexableLockSkipList(probability, max_level) {
+        bulk_load(first, last);
     }
 
     std::pair<bool, Value> search(Key search_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, search_key);
-        Node *cur = succs[0];
+        auto guard = _reclaimer.enter();
+        Node *cur = find(guard, search_key);
         return {cur -> key == search_key && !(cur -> beeing_deleted) && cur -> fully_linked, cur -> value};
     }
 
     void insert(Key insert_key, Value value) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        Level random_level = random_gen::random_level(_p, _max_level);
-        get_update_nodes(preds, succs, insert_key);
-        Node *x = succs[0];
-        if(x -> key == insert_key) {
-            x -> value = value;
+        if constexpr(live_index) {
+            insert_live(insert_key, value);
             return;
         }
-        Node *new_node = new Node(insert_key, value, random_level);
-        for(Level i = 0; i < random_level; ++i) {
-            new_node -> next[i] = succs[i];
-        }
-        new_node -> lock.lock(); // -> if node is not fully linked, other threads could already access this node
-        auto validate = [&](int j) {
-            return !(preds[j] -> beeing_deleted) && !(succs[j] -> beeing_deleted) && preds[j] -> next[j] == succs[j];
-        };
-        auto try_insert_at = [&](int j) {
-            if(validate(j)) {
-                preds[j] -> lock.lock();
-                if(validate(j)) {
-                    new_node -> next[j] = succs[j]; //update succs
-                    preds[j] -> next[j] = new_node;
-                    preds[j] -> lock.unlock();
-                    return true;
-                    }
-                preds[j] -> lock.unlock();
-            }
-            get_update_nodes(preds, succs, insert_key);
-            return false;
-        };
-        //thread that gets 0 level gets all levels
-        while(true) {
-            if(succs[0] -> key == insert_key) {
-                delete new_node;
-                return; //element was inserted by other thread
-            }
-            if(try_insert_at(0)) {
-                break;
-            }
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        Level random_level = _level_gen();
+        raise_top_level(random_level); //before the descent, so preds and succs cover all levels of the new node
+        Level top = get_update_nodes(guard, preds, succs, insert_key);
+        link(guard, preds, succs, insert_key, value, random_level, top);
+    }
+
+    //range of (key, value) pairs in ascending key order, one guard for the whole batch
+    //each key resumes the path of the previous key below the lowest level whose successor it does not overtake
+    template<class Iterator>
+    void insert_batch(Iterator first, Iterator last) {
+        if constexpr(live_index) {
+            for(; first != last; ++first) insert_live(first -> first, first -> second); //every key takes its own path
+            return;
         }
-        for(Level i = 1; i < random_level; ++i) {
-            while(!try_insert_at(i)) {}
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        Level path_top = 0; //preds and succs are filled below this level
+        for(; first != last; ++first) {
+            Level random_level = _level_gen();
+            raise_top_level(random_level);
+            path_top = resume_update_nodes(guard, preds, succs, first -> first, path_top);
+            link(guard, preds, succs, first -> first, first -> second, random_level, path_top);
         }
-        new_node -> fully_linked = true;
-        new_node -> lock.unlock(); //test
-        return;
     }
 
     bool remove(Key remove_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, remove_key);
+        if constexpr(live_index) {
+            return remove_live(remove_key);
+        }
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        Level top = get_update_nodes(guard, preds, succs, remove_key);
         Node *victim = succs[0];
         if(victim -> key != remove_key || !(victim -> fully_linked)) {
             return false;
@@ -156,15 +164,12 @@ public:
                     }
                     preds[i] -> lock.unlock();
                 }
-                get_update_nodes(preds, succs, remove_key);
+                top = get_update_nodes(guard, preds, succs, remove_key);
             }
         }
         victim -> lock.unlock();
-        //garbage collection
-        size_t index = random_gen::random_index(_num_queues);
-        _queue_locks[index].lock();
-        _queues[index].push(victim);
-        _queue_locks[index].unlock();
+        mark_dirty(preds, top);
+        guard.retire(victim); //garbage collection
         return true;
     }
 
@@ -181,16 +186,32 @@ public:
                 preds[i] = cur;
                 index[i] = cur_index;
             }
+            cur -> dirty = false;
             cur = cur -> next[0];
             cur_index++;
         }
+        _head -> dirty = false;
+    }
+
+    //O(#pointers / #threads), the level 0 list is cut at the nodes above _segment_level,
+    //segments are computed in parallel and the lengths above come from a prefix sum over the segment lengths
+    void compute_indices_parallel() {
+        compute_segments(false);
+    }
+
+    //recomputes only segments with inserts or removes since the last call, clean segments keep their lengths
+    void compute_indices_incremental() {
+        compute_segments(true);
     }
 
         //checks if index in range, if so returs value at i
     std::pair<bool, Value> element_at(int search_index) {
+        if constexpr(live_index) {
+            return element_at_live(search_index);
+        }
         Node *cur = _head;
         int cur_index = -1;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
             while(cur -> key != _max_key && cur_index + cur -> length[i] <= search_index) {
                 cur_index += cur -> length[i];
                 cur = cur -> next[i];
@@ -202,9 +223,12 @@ public:
 
     //checks if element exist, if so returs its rank
     std::pair<bool, Value> rank(Key search_key) {
+        if constexpr(live_index) {
+            return rank_live(search_key);
+        }
         Node *cur = _head;
         int cur_index = -1;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
             while(cur -> next[i].load() -> key <= search_key) {
                 cur_index += cur -> length[i];
                 cur = cur -> next[i];
@@ -215,7 +239,7 @@ public:
 
     //holds only for permuation from 0,..., n ! 
     bool is_consistent() {
-        compute_indices();
+        if constexpr(!live_index) compute_indices();
         Node *cur = _head;
         bool ok = true;
         while(cur -> key != _max_key) {
@@ -258,32 +282,513 @@ public:
         return v;
     }
 
+    //weakly consistent forward cursor over level 0, skips nodes that are beeing deleted or not fully linked
+    //holds a guard of the reclamation policy for its whole lifetime, keep it short lived
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _list._tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            skip(_cur -> key, true);
+            return *this;
+        }
+
+    private:
+        friend class IndexableLockSkipList;
+        Cursor(IndexableLockSkipList &list, Key bound, bool strict) : _list(list), _guard(list._reclaimer.enter()) {
+            _cur = _list.find(_guard, bound);
+            _guard.hold(_hp_cur, _cur);
+            skip(bound, strict);
+        }
+
+        //moves to the first visible node with key >= bound, > bound if strict
+        void skip(Key bound, bool strict) {
+            while(_cur != _list._tail && (_cur -> key < bound || (strict && _cur -> key == bound) || _cur -> beeing_deleted || !(_cur -> fully_linked))) {
+                Node *succ = _guard.protect(0, _cur -> next[0]);
+                //removed node might point to reclaimed nodes, search again from its key
+                if(Reclaim::needs_validation && _cur -> beeing_deleted) {
+                    succ = _list.find(_guard, _cur -> key);
+                }
+                _guard.hold(_hp_cur, succ);
+                _cur = succ;
+            }
+        }
+
+        static constexpr int _hp_cur = 2; //above the hazards of find
+        IndexableLockSkipList &_list;
+        Guard _guard;
+        Node *_cur;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        return Cursor(*this, search_key, false);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        return Cursor(*this, search_key, true);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
 private:
-    //returns a vector predecessors and successors, waitfree
-    void get_update_nodes(std::vector<Node*> &preds, std::vector<Node*> &succs, Key search_key) {
-        Node *pred = _head;
-        Node *succ;
-        for(int i = _max_level - 1; i >= 0; --i) {
-            succ = pred -> next[i];
-            // 2. condition for tail
-            while(succ -> key < search_key && succ -> key != succ -> next[i].load() -> key)  {
+    //towers follow bulk::Layout, nodes are created and linked in two independent parallel loops
+    template<class Iterator>
+    void bulk_load(Iterator first, Iterator last) {
+        const size_t n = last - first;
+        bulk::Layout layout(_p, _max_level, n);
+        std::vector<Node*> nodes(n + 2);
+        nodes[0] = _head;
+        nodes[n + 1] = _tail;
+        #pragma omp parallel for
+        for(size_t i = 1; i <= n; ++i) {
+            Level level = layout.level(i);
+            nodes[i] = new (level) Node(first[i - 1].first, first[i - 1].second, level);
+            nodes[i] -> fully_linked = true;
+        }
+        #pragma omp parallel for
+        for(size_t i = 0; i <= n; ++i) {
+            for(Level l = 0; l < nodes[i] -> level; ++l) {
+                nodes[i] -> next[l] = nodes[layout.next(i, l)];
+                nodes[i] -> length[l] = layout.next(i, l) - i;
+            }
+            nodes[i] -> dirty = false;
+        }
+        _top_level = layout.top();
+        _size = n;
+    }
+
+    //segments of about 1024 elements
+    static Level segment_level(const double &p, const Level &max_level) {
+        Level level = 0;
+        if(p > 0 && p < 1) {
+            level = static_cast<Level>(std::lround(std::log(1024.0) / std::log(1 / p)));
+        }
+        return std::clamp(level, 0, max_level - 1);
+    }
+
+    //the segment of a key starts at its pred on _segment_level
+    void mark_dirty(NodeArray &preds, Level top) {
+        if constexpr(live_index) return;
+        Node *first = _segment_level < top ? preds[_segment_level] : _head;
+        if(!first -> dirty.load(std::memory_order_relaxed)) {
+            first -> dirty = true;
+        }
+    }
+
+    void compute_segments(bool only_dirty) {
+        const Level s = _segment_level;
+        std::vector<Node*> splitters; //head, all nodes above s, tail
+        for(Node *cur = _head; cur != _tail; cur = cur -> next[s]) {
+            splitters.push_back(cur);
+        }
+        splitters.push_back(_tail);
+        const long num_segments = splitters.size() - 1;
+
+        #pragma omp parallel for schedule(dynamic, 16)
+        for(long j = 0; j < num_segments; ++j) {
+            if(only_dirty && !splitters[j] -> dirty) continue;
+            splitters[j] -> dirty = false;
+            compute_segment(splitters[j], splitters[j + 1]);
+        }
+
+        //index of each splitter, length[s] of a splitter is the size of its segment
+        std::vector<Length> index(num_segments + 1);
+        Length sum = 0;
+        #pragma omp parallel for reduction(inscan, +: sum)
+        for(long j = 0; j <= num_segments; ++j) {
+            index[j] = sum;
+            #pragma omp scan exclusive(sum)
+            sum += splitters[j] -> length[s];
+        }
+
+        NodeArray preds;
+        std::array<Length, MaxLevel> last;
+        for(Level i = s + 1; i < _max_level; ++i) {
+            preds[i] = _head;
+            last[i] = 0;
+        }
+        for(long j = 1; j <= num_segments; ++j) {
+            for(Level i = s + 1; i < splitters[j] -> level; ++i) {
+                preds[i] -> length[i] = index[j] - last[i];
+                preds[i] = splitters[j];
+                last[i] = index[j];
+            }
+        }
+    }
+
+    //lengths of levels 0, ..., _segment_level between two neighboring splitters, all of these spans end inside the segment
+    void compute_segment(Node *first, Node *last) {
+        const Level s = _segment_level;
+        NodeArray preds;
+        std::array<Length, MaxLevel> index;
+        std::fill(preds.begin(), preds.begin() + s + 1, first);
+        std::fill(index.begin(), index.begin() + s + 1, 0);
+        Node *cur = first;
+        Length cur_index = 0;
+        do {
+            cur = cur -> next[0];
+            cur_index++;
+            Level top = std::min(cur -> level, s + 1);
+            for(Level i = 0; i < top; ++i) {
+                preds[i] -> length[i] = cur_index - index[i];
+                preds[i] = cur;
+                index[i] = cur_index;
+            }
+        } while(cur != last);
+    }
+
+    //live index: a writer changes the spans of its preds below the level of its node and adjusts one length above,
+    //changed preds are taken exclusively (lock, then close span), adjusted ones are only shared and take atomic increments,
+    //so a span is never split or merged while writers inside it adjust it, but writers in one span run side by side
+    //every change to a span on a pred's level below needs that pred, the spans the writer counts over stay fixed
+    //the path is taken bottom up (descending keys, so no deadlocks) after the victim, _writers comes last
+    //levels above the top are not maintained, the new levels link head to tail and get the number of elements + 1,
+    //closing _writers keeps raises apart and makes _size exact, no node is locked
+    void raise_top_level_live(Level level) {
+        if(_top_level.load() >= level) {
+            return;
+        }
+        _writers.lock();
+        Level top = _top_level.load();
+        if(top < level) {
+            Length total = _size.load() + 1;
+            for(Level i = top; i < level; ++i) {
+                _head -> length[i] = total;
+            }
+            _top_level = level; //readers load the top before the head lengths
+        }
+        _writers.unlock();
+    }
+
+    static void lock_span(Node *x) {
+        x -> lock.lock();
+        x -> span.lock();
+    }
+
+    static void unlock_span(Node *x) {
+        x -> span.unlock();
+        x -> lock.unlock();
+    }
+
+    //takes preds[0], ..., preds[top - 1] once each, exclusively below changed, returns false and releases if the path changed
+    bool lock_path(NodeArray &preds, NodeArray &succs, Level changed, Level top) {
+        for(Level i = 0; i < top; ++i) {
+            if(i > 0 && preds[i] == preds[i - 1]) continue;
+            if(i < changed) lock_span(preds[i]);
+            else preds[i] -> span.lock_shared();
+        }
+        _writers.lock_shared();
+        bool valid = _top_level.load() == top;
+        for(Level i = 0; i < top && valid; ++i) {
+            valid = !(preds[i] -> beeing_deleted) && preds[i] -> next[i] == succs[i];
+        }
+        if(!valid) {
+            unlock_path(preds, changed, top);
+        }
+        return valid;
+    }
+
+    void unlock_path(NodeArray &preds, Level changed, Level top) {
+        _writers.unlock_shared();
+        for(Level i = 0; i < top; ++i) {
+            if(i > 0 && preds[i] == preds[i - 1]) continue;
+            if(i < changed) unlock_span(preds[i]);
+            else preds[i] -> span.unlock_shared();
+        }
+    }
+
+    //odd while the changed preds are rewritten, increments above leave the versions alone
+    void bump_path(NodeArray &preds, Level changed) {
+        for(Level i = 0; i < changed; ++i) {
+            if(i == 0 || preds[i] != preds[i - 1]) preds[i] -> version++;
+        }
+    }
+
+    void insert_live(Key insert_key, Value value) {
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        std::array<Length, MaxLevel> index; //index of preds[i] relative to preds[random_level - 1]
+        Level random_level = _level_gen();
+        raise_top_level_live(random_level);
+        while(true) {
+            Level top = get_update_nodes(guard, preds, succs, insert_key);
+            Node *x = succs[0];
+            if(x -> key == insert_key) {
+                x -> value = value;
+                return;
+            }
+            if(!lock_path(preds, succs, random_level, top)) {
+                continue;
+            }
+            //walk the level below from each changed pred to the next one
+            index[random_level - 1] = 0;
+            for(Level i = random_level - 1; i > 0; --i) {
+                Length cur_index = index[i];
+                for(Node *cur = preds[i]; cur != preds[i - 1]; cur = cur -> next[i - 1]) {
+                    cur_index += cur -> length[i - 1];
+                }
+                index[i - 1] = cur_index;
+            }
+            Length new_node_index = index[0] + 1;
+            Node *new_node = new (random_level) Node(insert_key, value, random_level);
+            new_node -> lock.lock();
+            bump_path(preds, random_level);
+            for(Level i = 0; i < random_level; ++i) {
+                new_node -> next[i] = succs[i];
+                new_node -> length[i] = preds[i] -> length[i] - (new_node_index - index[i]) + 1;
+                preds[i] -> length[i] = new_node_index - index[i];
+                preds[i] -> next[i] = new_node;
+            }
+            bump_path(preds, random_level);
+            for(Level i = random_level; i < top; ++i) {
+                preds[i] -> length[i].fetch_add(1);
+            }
+            _size++;
+            new_node -> fully_linked = true;
+            new_node -> lock.unlock();
+            unlock_path(preds, random_level, top);
+            return;
+        }
+    }
+
+    bool remove_live(Key remove_key) {
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        while(true) {
+            Level top = get_update_nodes(guard, preds, succs, remove_key);
+            Node *victim = succs[0];
+            if(victim -> key != remove_key || !(victim -> fully_linked)) {
+                return false;
+            }
+            if(victim -> beeing_deleted) {
+                return true;
+            }
+            lock_span(victim);
+            if(victim -> beeing_deleted) {
+                unlock_span(victim);
+                return true;
+            }
+            Level node_level = victim -> level;
+            if(!lock_path(preds, succs, node_level, top)) {
+                unlock_span(victim);
+                continue;
+            }
+            victim -> beeing_deleted = true;
+            bump_path(preds, node_level);
+            for(Level i = 0; i < node_level; ++i) {
+                preds[i] -> length[i] += victim -> length[i] - 1;
+                preds[i] -> next[i] = victim -> next[i].load();
+            }
+            bump_path(preds, node_level);
+            for(Level i = node_level; i < top; ++i) {
+                preds[i] -> length[i].fetch_sub(1);
+            }
+            _size--;
+            unlock_path(preds, node_level, top);
+            unlock_span(victim);
+            guard.retire(victim); //garbage collection
+            return true;
+        }
+    }
+
+    //reads next and length of one level as a consistent pair, a rewrite of a pred counts as either done or not started
+    //concurrent writers below search_key change one span on the path each, the result counts every such writer at most once
+    template<class Move>
+    Node* descent_live(Guard &guard, Length &cur_index, Move move) {
+        Node *cur, *succ;
+        int hp_cur, hp_succ;
+        retry:
+        cur = _head;
+        cur_index = -1;
+        hp_cur = 0, hp_succ = 1;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            while(true) {
+                unsigned version = cur -> version;
+                if(version & 1) {
+                    lock::cpu_relax();
+                    continue;
+                }
+                succ = guard.protect(hp_succ, cur -> next[i]);
+                Length length = cur -> length[i];
+                if(cur -> version != version) {
+                    lock::cpu_relax();
+                    continue;
+                }
+                if(Reclaim::needs_validation && cur -> beeing_deleted) goto retry;
+                if(!move(succ, cur_index, length)) break;
+                cur_index += length;
+                cur = succ;
+                std::swap(hp_cur, hp_succ);
+            }
+        }
+        return cur;
+    }
+
+    std::pair<bool, Value> element_at_live(int search_index) {
+        auto guard = _reclaimer.enter();
+        Length cur_index;
+        Node *cur = descent_live(guard, cur_index, [&](Node *succ, Length index, Length length) {
+            return succ != _tail && index + length <= search_index;
+        });
+        return {cur != _head && cur_index == search_index, cur -> value};
+    }
+
+    std::pair<bool, Value> rank_live(Key search_key) {
+        auto guard = _reclaimer.enter();
+        Length cur_index;
+        Node *cur = descent_live(guard, cur_index, [&](Node *succ, Length, Length) {
+            return succ -> key <= search_key;
+        });
+        return {cur -> key == search_key, cur_index};
+    }
+
+    //links a new node between preds and succs, refreshes them and top on conflicts
+    //afterwards preds holds the new node on its levels, so a following larger key can reuse the path
+    void link(Guard &guard, NodeArray &preds, NodeArray &succs, Key insert_key, Value value, Level random_level, Level &top) {
+        Node *x = succs[0];
+        if(x -> key == insert_key) {
+            x -> value = value;
+            return;
+        }
+        Node *new_node = new (random_level) Node(insert_key, value, random_level);
+        for(Level i = 0; i < random_level; ++i) {
+            new_node -> next[i] = succs[i];
+        }
+        new_node -> lock.lock(); // -> if node is not fully linked, other threads could already access this node
+        auto validate = [&](int j) {
+            return !(preds[j] -> beeing_deleted) && !(succs[j] -> beeing_deleted) && preds[j] -> next[j] == succs[j];
+        };
+        auto try_insert_at = [&](int j) {
+            if(validate(j)) {
+                preds[j] -> lock.lock();
+                if(validate(j)) {
+                    new_node -> next[j] = succs[j]; //update succs
+                    preds[j] -> next[j] = new_node;
+                    preds[j] -> lock.unlock();
+                    return true;
+                    }
+                preds[j] -> lock.unlock();
+            }
+            top = get_update_nodes(guard, preds, succs, insert_key);
+            return false;
+        };
+        //thread that gets 0 level gets all levels
+        while(true) {
+            if(succs[0] -> key == insert_key) {
+                delete new_node;
+                return; //element was inserted by other thread
+            }
+            if(try_insert_at(0)) {
+                break;
+            }
+        }
+        for(Level i = 1; i < random_level; ++i) {
+            while(!try_insert_at(i)) {}
+        }
+        new_node -> fully_linked = true;
+        mark_dirty(preds, top);
+        //the path continues behind the new node, it can not be unlinked before its lock is released
+        for(Level i = 0; i < random_level; ++i) {
+            preds[i] = new_node;
+            guard.hold(3 + 2 * i, new_node);
+        }
+        new_node -> lock.unlock();
+        return;
+    }
+
+    //levels above the highest tower only link head to tail, the top never decreases while threads run
+    void raise_top_level(Level level) {
+        Level top = _top_level.load(std::memory_order_relaxed);
+        while(top < level && !_top_level.compare_exchange_weak(top, level)) {}
+    }
+
+    //descent without recording predecessors, stops at the first level that contains search_key
+    Node* find(Guard &guard, Key search_key) {
+        Node *pred, *succ = _tail;
+        int hp_pred, hp_succ; //alternating hazard indices
+        retry:
+        pred = _head;
+        hp_pred = 0, hp_succ = 1;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            succ = guard.protect(hp_succ, pred -> next[i]);
+            if(Reclaim::needs_validation && pred -> beeing_deleted) goto retry;
+            while(succ -> key < search_key && succ != _tail)  {
                 pred = succ;
-                succ = succ -> next[i];
+                std::swap(hp_pred, hp_succ);
+                succ = guard.protect(hp_succ, pred -> next[i]);
+                if(Reclaim::needs_validation && pred -> beeing_deleted) goto retry;
+            }
+            if(succ -> key == search_key) {
+                return succ;
+            }
+        }
+        return succ;
+    }
+
+    //climbs the previous path to the lowest level whose pred lies before search_key and whose successor is not overtaken
+    //keeps the levels above and walks on from that pred, returns the number of filled levels
+    //a removed pred can link past newer nodes, then the descent starts at head
+    Level resume_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs, Key search_key, Level path_top) {
+        Level start = 0;
+        while(start < path_top && !(preds[start] -> key < search_key && search_key <= succs[start] -> key)) start++;
+        if(path_top != _top_level.load() || start == path_top || preds[start] -> beeing_deleted) {
+            return get_update_nodes(guard, preds, succs, search_key);
+        }
+        return get_update_nodes(guard, preds, succs, search_key, start + 1, path_top);
+    }
+
+    //returns a vector predecessors and successors and the top they were taken from, waitfree
+    //only levels below the current top are filled, every linked or inserting node lies below it
+    //with resume > 0 the levels from resume up to path_top are kept and the descent walks on from preds[resume - 1]
+    //preds and succs stay protected by the guard until the next call
+    Level get_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs, Key search_key, Level resume = 0, Level path_top = 0) {
+        Node *pred, *succ;
+        Level top, from;
+        int hp_pred, hp_succ; //alternating hazard indices
+        retry:
+        top = resume > 0 ? path_top : _top_level.load();
+        from = resume > 0 ? resume : top;
+        pred = resume > 0 ? preds[resume - 1] : _head;
+        resume = 0; //retries begin at head
+        hp_pred = 0, hp_succ = 1;
+        for(int i = from - 1; i >= 0; --i) {
+            succ = guard.protect(hp_succ, pred -> next[i]);
+            //removed pred still points to succ, which might already be reclaimed
+            if(Reclaim::needs_validation && pred -> beeing_deleted) goto retry;
+            while(succ -> key < search_key && succ != _tail)  {
+                pred = succ;
+                std::swap(hp_pred, hp_succ);
+                succ = guard.protect(hp_succ, pred -> next[i]);
+                if(Reclaim::needs_validation && pred -> beeing_deleted) goto retry;
             }
             preds[i] = pred;
             succs[i] = succ;
+            guard.hold(3 + 2 * i, pred);
+            guard.hold(4 + 2 * i, succ);
         }
-        return;
+        return top;
     }
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
+    const Level _segment_level; //nodes above this level cut the list into segments for the parallel compute_indices
     Node *_head;
     Node *_tail;
+    std::atomic<Level> _top_level{1}; //number of levels used by any tower
+    alignas(64) lock::SharedGate _writers; //live index writers share it, raising the top closes it
+    std::atomic<Length> _size{0}; //number of elements, maintained by live index writers
 
-    size_t _num_queues = 12;
-    std::vector<std::queue<Node*>> _queues{_num_queues};
-    QueueLock *_queue_locks;
+    Reclaim _reclaimer;
 
     const Key _min_key = std::numeric_limits<Key>::min();
     const Key _max_key = std::numeric_limits<Key>::max();
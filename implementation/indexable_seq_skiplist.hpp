@@ -1,38 +1,70 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <limits>
 #include <iostream>
+#include <algorithm>
+#include <new>
 
+#include "implementation/node_pool.hpp"
+#include "implementation/bulk_load.hpp"
 #include "random_generator.hpp"
 
-template <class Key, class Value>
+//MaxLevel bounds the max_level given at runtime
+template <class Key, class Value, int MaxLevel = 64>
 class IndexableSeqSkipList
 {
 private:
+    struct Node;
     using Level = int;
+    using NodeArray = std::array<Node*, MaxLevel>; //update nodes and their indices live on the stack
+    using IndexArray = std::array<int, MaxLevel>;
+    //next and length towers are stored inline behind the node, blocks come from the node pool
     struct Node {
-        Node(Key k, Value val, Level lev) : key(k), value(val), next(lev), length_next(lev, 0) {};
-        Key key;
+        Node(Key k, Value val, Level lev) : level(lev), value(val), key(k) {
+            length_next = reinterpret_cast<int*>(next + level);
+            std::fill(next, next + level, nullptr);
+            std::fill(length_next, length_next + level, 0);
+        };
+        static void* operator new(size_t size, Level lev) {
+            return pool::NodePool<Node>::allocate(size + lev * (sizeof(Node*) + sizeof(int)), lev);
+        }
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level;
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+        Level get_level() { return level;}
+
+        int *length_next; //points behind next[level - 1]
+        Level level;
         Value value;
-        std::vector<Node*> next; 
-        std::vector<int> length_next; 
-        Level get_level() { return next.size();}
+        Key key;
+        Node* next[]; 
     };
 public:
-    IndexableSeqSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
-        _head = new Node(std::numeric_limits<Key>::min(), Value(), _max_level);
-        _tail = new Node(std::numeric_limits<Key>::max(), Value(), _max_level);
+    IndexableSeqSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level) {
+        _head = new (_max_level) Node(std::numeric_limits<Key>::min(), Value(), _max_level);
+        _tail = new (_max_level) Node(std::numeric_limits<Key>::max(), Value(), _max_level);
         for(int i = 0; i < _max_level; ++i) {
             _head -> next[i] = _tail;
             _head -> length_next[i] = 1;
         }
     };
 
+    //bulk load from a random access range of (key, value) pairs sorted by unique keys, O(n) and parallel with OpenMP
+    template<class Iterator>
+    IndexableSeqSkipList(const double &probability, const Level &max_level, Iterator first, Iterator last) : IndexableSeqSkipList(probability, max_level) {
+        bulk_load(first, last);
+    }
+
     //checks if element with search_key exist, if so it returs the value of the searched element
     std::pair<bool, Value> search(Key &search_key) {
         Node *cur = _head;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] -> key < search_key) {
                 cur = cur -> next[i];
             }
@@ -45,7 +77,7 @@ public:
     std::pair<bool, Value> element_at(int search_index) {
         Node *cur = _head;
         int cur_index = -1;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] != NULL && cur_index + cur -> length_next[i] <= search_index) {
                 cur_index += cur -> length_next[i];
                 cur = cur -> next[i];
@@ -59,7 +91,7 @@ public:
     std::pair<bool, Value> rank(Key &search_key) {
         Node *cur = _head;
         int cur_index = -1;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] -> key <= search_key) {
                 cur_index += cur -> length_next[i];
                 cur = cur -> next[i];
@@ -76,8 +108,9 @@ public:
             x -> value = value;
         }
         else {
-            Level random_level = random_gen::random_level(_p, _max_level);
-            Node *new_node = new Node(insert_key, value, random_level);
+            Level random_level = _level_gen();
+            Node *new_node = new (random_level) Node(insert_key, value, random_level);
+            _top_level = std::max(_top_level, random_level);
             int new_node_index = index[0] + 1;
             for(int i = 0; i < random_level; ++i) {
                 new_node -> length_next[i] = (update[i] -> length_next[i]) - (new_node_index - index[i]) + 1;
@@ -86,7 +119,7 @@ public:
                 new_node -> next[i] = update[i] -> next[i];
                 update[i] -> next[i] = new_node;
             }
-            for(int i = random_level; i < (int)update.size(); ++i) {
+            for(int i = random_level; i < _max_level; ++i) {
                 update[i] -> length_next[i]++;
             }
         }
@@ -102,9 +135,12 @@ public:
 
                 update[i] -> next[i] = to_remove -> next[i];
             }
-            for(int i = remove_level; i < (int) update.size(); ++i) {
+            for(int i = remove_level; i < _max_level; ++i) {
                 update[i] -> length_next[i]--;
             }
+            while(_top_level > 1 && _head -> next[_top_level - 1] == _tail) {
+                _top_level--;
+            }
             delete to_remove;
             return true;
         }
@@ -124,14 +160,89 @@ public:
         }
     }
 
+    //forward cursor over level 0, invalidated by a remove of its element
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            _cur = _cur -> next[0];
+            return *this;
+        }
+
+    private:
+        friend class IndexableSeqSkipList;
+        Cursor(Node *cur, Node *tail) : _cur(cur), _tail(tail) {}
+
+        Node *_cur;
+        Node *_tail;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        Node *cur = _head;
+        for(int i = _top_level - 1; i >= 0; --i) {
+            while(cur -> next[i] -> key < search_key) {
+                cur = cur -> next[i];
+            }
+        }
+        return Cursor(cur -> next[0], _tail);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        Node *cur = _head;
+        for(int i = _top_level - 1; i >= 0; --i) {
+            while(cur -> next[i] != _tail && cur -> next[i] -> key <= search_key) {
+                cur = cur -> next[i];
+            }
+        }
+        return Cursor(cur -> next[0], _tail);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
 private:
+    //towers follow bulk::Layout, nodes are created and linked in two independent parallel loops
+    template<class Iterator>
+    void bulk_load(Iterator first, Iterator last) {
+        const size_t n = last - first;
+        bulk::Layout layout(_p, _max_level, n);
+        std::vector<Node*> nodes(n + 2);
+        nodes[0] = _head;
+        nodes[n + 1] = _tail;
+        #pragma omp parallel for
+        for(size_t i = 1; i <= n; ++i) {
+            Level level = layout.level(i);
+            nodes[i] = new (level) Node(first[i - 1].first, first[i - 1].second, level);
+        }
+        #pragma omp parallel for
+        for(size_t i = 0; i <= n; ++i) {
+            for(Level l = 0; l < nodes[i] -> level; ++l) {
+                nodes[i] -> next[l] = nodes[layout.next(i, l)];
+                nodes[i] -> length_next[l] = layout.next(i, l) - i;
+            }
+        }
+        _top_level = layout.top();
+    }
+
     //returns a vector of the rightmost node visited on each level and it's index
-    std::pair<std::vector<Node*>, std::vector<int>> get_update_nodes(Key &search_key) {
-        std::vector<Node*> update(_max_level);
-        std::vector<int> index(_max_level);
+    std::pair<NodeArray, IndexArray> get_update_nodes(Key &search_key) {
+        NodeArray update;
+        IndexArray index;
         Node *cur = _head;
         int cur_index = 0;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        //levels above the top only link head to tail, their lengths are still kept up to date
+        std::fill(update.begin() + _top_level, update.begin() + _max_level, _head);
+        std::fill(index.begin() + _top_level, index.begin() + _max_level, 0);
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] -> key < search_key) {
                 cur_index += cur -> length_next[i];
                 cur = cur -> next[i];
@@ -144,7 +255,9 @@ private:
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
     Node *_head;
     Node *_tail;
+    Level _top_level = 1; //levels from here upwards only link head to tail
 
 };
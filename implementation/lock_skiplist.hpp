@@ -1,168 +1,264 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <algorithm>
 #include <limits>
 #include <iostream>
 #include <atomic>
 #include <queue>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
 
 #include "implementation/spinlock.hpp"
+#include "implementation/reclamation.hpp"
+#include "implementation/node_pool.hpp"
+#include "implementation/bulk_load.hpp"
 #include "random_generator.hpp"
 
 #define COUNTER_SIZE 100
+#define MULTI_SEARCH_GROUP 16 //traversals in flight in multi_search
 
-//link each level individually
-template <class Key, class Value, bool do_count = false>
+//link each level individually, MaxLevel bounds the max_level given at runtime
+//NodeLock guards a node's next pointers, lock::BackoffSpinlock<> pays off when many threads insert next to the same keys
+template <class Key, class Value, bool do_count = false, template<class> class Reclaimer = reclamation::GarbageQueues, int MaxLevel = 64, class NodeLock = lock::Spinlock>
 class LockSkipList
 {
 private:
+    struct Node;
     using Level = int;
-    using Lock = lock::Spinlock;
-    using QueueLock = lock::Spinlock;
+    using Lock = NodeLock;
 
     // slower
     // using Lock = std::mutex; 
-    // using QueueLock = std::mutex;
-    struct Node {
-        Node(Key k, Value val, Level lev) : 
-         key(k), value(val), level(lev), lock(),
-         beeing_deleted(false), fully_linked(false) {
-             next = new std::atomic<Node*>[level];
+
+    using Reclaim = Reclaimer<Node>;
+    using Guard = typename Reclaim::Guard;
+    using NodeArray = std::array<Node*, MaxLevel>; //preds and succs live on the stack
+
+    //the default spinlock becomes a bit of the node state word, other lock policies keep their own member
+    static constexpr bool packed_lock = std::is_same_v<Lock, lock::Spinlock>;
+    struct NoLock {};
+
+    //tower is stored inline behind the node, one cache line aligned block per node from the node pool
+    //the block holds the header and the tower only, level 1 to 6 nodes with int keys fit one cache line
+    struct alignas(64) Node {
+        static_assert(MaxLevel <= 0xff, "level must fit the state word");
+        static constexpr uint32_t _level_mask = 0xff;
+        static constexpr uint32_t _locked = 1u << 8;
+        static constexpr uint32_t _linked = 1u << 9;  //all pointers are set
+        static constexpr uint32_t _deleted = 1u << 10; //some threads currently deletes this node
+
+        Node(Key k, Value val, Level lev) : state(uint32_t(lev)), value(val), key(k) {
+             for(Level i = 0; i < lev; ++i) {
+                 new (&next[i]) std::atomic<Node*>(nullptr);
+             }
          };
-        ~Node() {
-            delete next;
+        static void* operator new(size_t, Level lev) {
+            return pool::NodePool<Node>::allocate(offsetof(Node, next) + lev * sizeof(std::atomic<Node*>), lev);
+        }
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level();
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+
+        Level level() const { return state.load(std::memory_order_relaxed) & _level_mask; }
+        //linked and not deleted, one load
+        bool visible() const { return (state.load() & (_linked | _deleted)) == _linked; }
+        bool deleted() const { return state.load() & _deleted; }
+        bool linked() const { return state.load() & _linked; }
+        void set_linked() { state.fetch_or(_linked); }
+        //true for the one thread that sets the flag
+        bool mark_deleted() { return !(state.fetch_or(_deleted) & _deleted); }
+
+        void lock() {
+            if constexpr(packed_lock) {
+                while(state.fetch_or(_locked, std::memory_order_acquire) & _locked) {
+                    while(state.load(std::memory_order_relaxed) & _locked) lock::cpu_relax();
+                }
+            }
+            else {
+                node_lock.lock();
+            }
+        }
+        void unlock() {
+            if constexpr(packed_lock) state.fetch_and(~_locked, std::memory_order_release);
+            else node_lock.unlock();
         }
-        std::atomic<Key> key;
+
+        std::atomic<uint32_t> state; //level | lock bit | linked | deleted
+        [[no_unique_address]] std::conditional_t<packed_lock, NoLock, Lock> node_lock;
         std::atomic<Value> value;
-        std::atomic<Node*> *next;
-        Level level;
-        Lock lock;
-        std::atomic<bool> beeing_deleted; //some threads currently deletes this node
-        std::atomic<bool> fully_linked;   //all pointers are set
+        std::atomic<Key> key; //next to next[0], read together on every hop
+        std::atomic<Node*> next[];
     };
 public:
-    LockSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
-        _head = new Node(_min_key, Value(), _max_level);
-        _tail = new Node(_max_key, Value(), _max_level);
+    LockSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level), _reclaimer(_max_level) {
+        _head = new (_max_level) Node(_min_key, Value(), _max_level);
+        _tail = new (_max_level) Node(_max_key, Value(), _max_level);
         for(int i = 0; i < _max_level; ++i) {
             _head -> next[i] = _tail;
         }
         for(int i = 0; i < _max_level; ++i) {
             _tail -> next[i] = _tail; //safety
         }
-        _queue_locks = new QueueLock[_num_queues];
     };
 
-    ~LockSkipList() {
-        for(auto &q : _queues) {
-            while(!q.empty()) {
-                auto ptr = q.front(); q.pop();
-                delete ptr;
-            }
-        }
-        delete _queue_locks;
+    //bulk load from a random access range of (key, value) pairs sorted by unique keys, O(n) and parallel with OpenMP
+    template<class Iterator>
+    LockSkipList(const double &probability, const Level &max_level, Iterator first, Iterator last) : LockSkipList(probability, max_level) {
+        bulk_load(first, last);
     }
 
     std::pair<bool, Value> search(Key search_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, search_key);
-        Node *cur = succs[0];
-        return {cur -> key == search_key && !(cur -> beeing_deleted) && cur -> fully_linked, cur -> value};
+        auto guard = _reclaimer.enter();
+        Node *cur = find(guard, search_key);
+        return {cur -> key == search_key && cur -> visible(), cur -> value};
     }
 
-    void insert(Key insert_key, Value value) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        Level random_level = random_gen::random_level(_p, _max_level);
-        get_update_nodes(preds, succs, insert_key);
-        Node *x = succs[0];
-        if(x -> key == insert_key) {
-            x -> value = value;
+    //lookups for a batch of keys, results[i] = search(keys[i])
+    //a group of traversals advances one hop per turn and prefetches its next node, so their cache misses overlap
+    //hazard pointers protect a single traversal per guard, there each key is searched on its own
+    void multi_search(const std::vector<Key> &keys, std::vector<std::pair<bool, Value>> &results) {
+        results.resize(keys.size());
+        if constexpr(Reclaim::needs_validation) {
+            for(size_t i = 0; i < keys.size(); ++i) {
+                results[i] = search(keys[i]);
+            }
             return;
         }
-        Node *new_node = new Node(insert_key, value, random_level);
-        for(Level i = 0; i < random_level; ++i) {
-            new_node -> next[i] = succs[i];
-        }
-        new_node -> lock.lock(); // -> if node is not fully linked, other threads could already access this node
-        auto validate = [&](int j) {
-            return !(preds[j] -> beeing_deleted) && !(succs[j] -> beeing_deleted) && preds[j] -> next[j] == succs[j];
+        [[maybe_unused]] auto guard = _reclaimer.enter(); //keeps visited nodes alive for all traversals
+        struct Traversal {
+            size_t index;
+            Level level;
+            Node *pred, *succ;
         };
-        auto try_insert_at = [&](int j) {
-            if(validate(j)) {
-                preds[j] -> lock.lock();
-                if(validate(j)) {
-                    new_node -> next[j] = succs[j]; //update succs
-                    preds[j] -> next[j] = new_node;
-                    preds[j] -> lock.unlock();
-                    return true;
-                }
-                preds[j] -> lock.unlock();
-            }
-            get_update_nodes(preds, succs, insert_key);
-            return false;
+        std::array<Traversal, MULTI_SEARCH_GROUP> group;
+        size_t next_key = 0, active = 0;
+        auto start = [&](Traversal &t) {
+            t.index = next_key++;
+            t.level = _top_level.load() - 1;
+            t.pred = _head;
+            t.succ = _head -> next[t.level];
+            __builtin_prefetch(t.succ);
         };
-        //thread that gets 0 level gets all levels
-        while(true) {
-            if(succs[0] -> key == insert_key) {
-                delete new_node;
-                return; //element was inserted by other thread
-            }
-            if(try_insert_at(0)) {
-                break;
+        for(; active < MULTI_SEARCH_GROUP && next_key < keys.size(); ++active) {
+            start(group[active]);
+        }
+        //same steps as find, one node per turn
+        while(active > 0) {
+            for(size_t g = 0; g < active;) {
+                Traversal &t = group[g];
+                Key search_key = keys[t.index];
+                Node *succ = t.succ;
+                if(succ -> key < search_key && succ != _tail) {
+                    t.pred = succ;
+                    t.succ = succ -> next[t.level];
+                }
+                else if(succ -> key != search_key && t.level > 0) {
+                    t.succ = t.pred -> next[--t.level];
+                }
+                else {
+                    results[t.index] = {succ -> key == search_key && succ -> visible(), succ -> value};
+                    if(next_key == keys.size()) {
+                        t = group[--active];
+                        continue;
+                    }
+                    start(t);
+                }
+                __builtin_prefetch(t.succ);
+                ++g;
             }
         }
-        for(Level i = 1; i < random_level; ++i) {
-            while(!try_insert_at(i)) {}
+    }
+
+    void insert(Key insert_key, Value value) {
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        Level random_level = _level_gen();
+        raise_top_level(random_level); //before the descent, so preds and succs cover all levels of the new node
+        get_update_nodes(guard, preds, succs, insert_key);
+        link(guard, preds, succs, insert_key, value, random_level);
+    }
+
+    //per thread finger on the path of its last operation, the next one climbs from there instead of descending from head
+    //O(log d) steps for a key at distance d from the previous one
+    //keeps a guard while it lives, so remembered nodes can not be reclaimed, drop it between bursts of nearby accesses
+    class Finger {
+    private:
+        friend class LockSkipList;
+        Finger(LockSkipList &list) : _guard(list._reclaimer.enter()) {}
+
+        Guard _guard;
+        NodeArray _preds, _succs;
+        Level _top = 0; //preds and succs are filled below this level
+    };
+
+    Finger finger() {
+        return Finger(*this);
+    }
+
+    std::pair<bool, Value> search(Finger &finger, Key search_key) {
+        finger._top = resume_update_nodes(finger._guard, finger._preds, finger._succs, search_key, finger._top);
+        Node *cur = finger._succs[0];
+        return {cur -> key == search_key && cur -> visible(), cur -> value};
+    }
+
+    void insert(Finger &finger, Key insert_key, Value value) {
+        Level random_level = _level_gen();
+        raise_top_level(random_level);
+        finger._top = resume_update_nodes(finger._guard, finger._preds, finger._succs, insert_key, finger._top);
+        link(finger._guard, finger._preds, finger._succs, insert_key, value, random_level);
+    }
+
+    //range of (key, value) pairs in ascending key order, each key resumes the path of the previous one
+    template<class Iterator>
+    void insert_batch(Iterator first, Iterator last) {
+        Finger path(*this);
+        for(; first != last; ++first) {
+            insert(path, first -> first, first -> second);
         }
-        new_node -> fully_linked = true;
-        new_node -> lock.unlock();
-        return;
     }
 
     bool remove(Key remove_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, remove_key);
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        get_update_nodes(guard, preds, succs, remove_key);
         Node *victim = succs[0];
-        if(victim -> key != remove_key || !(victim -> fully_linked)) {
+        if(victim -> key != remove_key || !(victim -> linked())) {
             return false;
         }
-        if(victim -> beeing_deleted) {
-            return true;
-        }
         //one thread set marked flag and continues removing it
-        bool expect = false;
-        if(!victim -> beeing_deleted.compare_exchange_strong(expect, true)) {
+        if(!victim -> mark_deleted()) {
             return true;
         }
-        Level node_level = victim -> level;        
+        Level node_level = victim -> level();
         auto validate = [&](int j) {
-            return !(preds[j] -> beeing_deleted) && preds[j] -> next[j] == victim;
+            return !(preds[j] -> deleted()) && preds[j] -> next[j] == victim;
         };
-        victim -> lock.lock();
+        victim -> lock();
         for(Level i = node_level - 1; i >= 0; --i) {
             while(true) {
                 if(validate(i)) {
-                    preds[i] -> lock.lock();
+                    preds[i] -> lock();
                     if(validate(i)) {
                         preds[i] -> next[i] = victim -> next[i].load();
-                        preds[i] -> lock.unlock();
+                        preds[i] -> unlock();
                         break;
                     }
-                    preds[i] -> lock.unlock();
+                    preds[i] -> unlock();
                 }
-                get_update_nodes(preds, succs, remove_key);
+                get_update_nodes(guard, preds, succs, remove_key);
             }
         }
-        victim -> lock.unlock();
+        victim -> unlock();
 
-        //garbage collection, shared ptr is to slow
-        size_t index = random_gen::random_index(_num_queues);
-        _queue_locks[index].lock();
-        _queues[index].push(victim);
-        _queue_locks[index].unlock();
+        guard.retire(victim); //garbage collection, shared ptr is to slow
         return true;
     }
 
@@ -195,6 +291,63 @@ public:
         return v;
     }
 
+    //weakly consistent forward cursor over level 0, skips nodes that are beeing deleted or not fully linked
+    //holds a guard of the reclamation policy for its whole lifetime, keep it short lived
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _list._tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            skip(_cur -> key, true);
+            return *this;
+        }
+
+    private:
+        friend class LockSkipList;
+        Cursor(LockSkipList &list, Key bound, bool strict) : _list(list), _guard(list._reclaimer.enter()) {
+            _cur = _list.find(_guard, bound);
+            _guard.hold(_hp_cur, _cur);
+            skip(bound, strict);
+        }
+
+        //moves to the first visible node with key >= bound, > bound if strict
+        void skip(Key bound, bool strict) {
+            while(_cur != _list._tail && (_cur -> key < bound || (strict && _cur -> key == bound) || !(_cur -> visible()))) {
+                Node *succ = _guard.protect(0, _cur -> next[0]);
+                //removed node might point to reclaimed nodes, search again from its key
+                if(Reclaim::needs_validation && _cur -> deleted()) {
+                    succ = _list.find(_guard, _cur -> key);
+                }
+                _guard.hold(_hp_cur, succ);
+                _cur = succ;
+            }
+        }
+
+        static constexpr int _hp_cur = 2; //above the hazards of find
+        LockSkipList &_list;
+        Guard _guard;
+        Node *_cur;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        return Cursor(*this, search_key, false);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        return Cursor(*this, search_key, true);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
     void init_counter() {
         for(int i = 0; i < COUNTER_SIZE; ++i) {
             _counter[i] = 0;
@@ -210,32 +363,166 @@ public:
     }
 
 private:
-    //returns a vector predecessors and successors, waitfree
-    void get_update_nodes(std::vector<Node*> &preds, std::vector<Node*> &succs,  Key search_key) {
+    //towers follow bulk::Layout, nodes are created and linked in two independent parallel loops
+    template<class Iterator>
+    void bulk_load(Iterator first, Iterator last) {
+        const size_t n = last - first;
+        bulk::Layout layout(_p, _max_level, n);
+        std::vector<Node*> nodes(n + 2);
+        nodes[0] = _head;
+        nodes[n + 1] = _tail;
+        #pragma omp parallel for
+        for(size_t i = 1; i <= n; ++i) {
+            Level level = layout.level(i);
+            nodes[i] = new (level) Node(first[i - 1].first, first[i - 1].second, level);
+            nodes[i] -> set_linked();
+        }
+        #pragma omp parallel for
+        for(size_t i = 0; i <= n; ++i) {
+            for(Level l = 0, top = nodes[i] -> level(); l < top; ++l) {
+                nodes[i] -> next[l] = nodes[layout.next(i, l)];
+            }
+        }
+        _top_level = layout.top();
+    }
+
+    //levels above the highest tower only link head to tail, the top never decreases while threads run
+    void raise_top_level(Level level) {
+        Level top = _top_level.load(std::memory_order_relaxed);
+        while(top < level && !_top_level.compare_exchange_weak(top, level)) {}
+    }
+
+    //links a new node between preds and succs, refreshes them on conflicts
+    //afterwards preds holds the new node on its levels, so a following larger key can reuse the path
+    void link(Guard &guard, NodeArray &preds, NodeArray &succs, Key insert_key, Value value, Level random_level) {
+        Node *x = succs[0];
+        if(x -> key == insert_key) {
+            x -> value = value;
+            return;
+        }
+        Node *new_node = new (random_level) Node(insert_key, value, random_level);
+        for(Level i = 0; i < random_level; ++i) {
+            new_node -> next[i] = succs[i];
+        }
+        new_node -> lock(); // -> if node is not fully linked, other threads could already access this node
+        auto validate = [&](int j) {
+            return !(preds[j] -> deleted()) && !(succs[j] -> deleted()) && preds[j] -> next[j] == succs[j];
+        };
+        auto try_insert_at = [&](int j) {
+            if(validate(j)) {
+                preds[j] -> lock();
+                if(validate(j)) {
+                    new_node -> next[j] = succs[j]; //update succs
+                    preds[j] -> next[j] = new_node;
+                    preds[j] -> unlock();
+                    return true;
+                }
+                preds[j] -> unlock();
+            }
+            get_update_nodes(guard, preds, succs, insert_key);
+            return false;
+        };
+        //thread that gets 0 level gets all levels
+        while(true) {
+            if(succs[0] -> key == insert_key) {
+                delete new_node;
+                return; //element was inserted by other thread
+            }
+            if(try_insert_at(0)) {
+                break;
+            }
+        }
+        for(Level i = 1; i < random_level; ++i) {
+            while(!try_insert_at(i)) {}
+        }
+        new_node -> set_linked();
+        //the path continues behind the new node, it can not be unlinked before its lock is released
+        for(Level i = 0; i < random_level; ++i) {
+            preds[i] = new_node;
+            guard.hold(3 + 2 * i, new_node);
+        }
+        new_node -> unlock();
+        return;
+    }
+
+
+    //descent without recording predecessors, stops at the first level that contains search_key
+    Node* find(Guard &guard, Key search_key) {
         if constexpr(do_count) _counter[random_gen::random_index(COUNTER_SIZE)]++; //special metric
-        Node *pred = _head;
-        Node *succ;
-        for(int i = _max_level - 1; i >= 0; --i) {
-            succ = pred -> next[i];
-            //2. condition for tail
-            while(succ -> key < search_key && succ -> key != succ -> next[i].load() -> key)  {
+        Node *pred, *succ = _tail;
+        int hp_pred, hp_succ; //alternating hazard indices
+        retry:
+        pred = _head;
+        hp_pred = 0, hp_succ = 1;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            succ = guard.protect(hp_succ, pred -> next[i]);
+            if(Reclaim::needs_validation && pred -> deleted()) goto retry;
+            while(succ -> key < search_key && succ != _tail)  {
                 pred = succ;
-                succ = succ -> next[i];
+                std::swap(hp_pred, hp_succ);
+                succ = guard.protect(hp_succ, pred -> next[i]);
+                if(Reclaim::needs_validation && pred -> deleted()) goto retry;
+            }
+            if(succ -> key == search_key) {
+                return succ;
+            }
+        }
+        return succ;
+    }
+
+    //climbs the previous path to the lowest level whose pred lies before search_key and whose successor is not overtaken
+    //keeps the levels above and walks on from that pred, returns the number of filled levels
+    //a removed pred can link past newer nodes, then the descent starts at head
+    Level resume_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs, Key search_key, Level path_top) {
+        Level start = 0;
+        while(start < path_top && !(preds[start] -> key < search_key && search_key <= succs[start] -> key)) start++;
+        if(path_top != _top_level.load() || start == path_top || preds[start] -> deleted()) {
+            return get_update_nodes(guard, preds, succs, search_key);
+        }
+        return get_update_nodes(guard, preds, succs, search_key, start + 1, path_top);
+    }
+
+    //returns a vector predecessors and successors and the number of filled levels, waitfree
+    //only levels below the current top are filled, every linked or inserting node lies below it
+    //with resume > 0 the levels from resume up to path_top are kept and the descent walks on from preds[resume - 1]
+    //preds and succs stay protected by the guard until the next call
+    Level get_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs, Key search_key, Level resume = 0, Level path_top = 0) {
+        if constexpr(do_count) _counter[random_gen::random_index(COUNTER_SIZE)]++; //special metric
+        Node *pred, *succ;
+        Level top, from;
+        int hp_pred, hp_succ; //alternating hazard indices
+        retry:
+        top = resume > 0 ? path_top : _top_level.load();
+        from = resume > 0 ? resume : top;
+        pred = resume > 0 ? preds[resume - 1] : _head;
+        resume = 0; //retries begin at head
+        hp_pred = 0, hp_succ = 1;
+        for(int i = from - 1; i >= 0; --i) {
+            succ = guard.protect(hp_succ, pred -> next[i]);
+            //removed pred still points to succ, which might already be reclaimed
+            if(Reclaim::needs_validation && pred -> deleted()) goto retry;
+            while(succ -> key < search_key && succ != _tail)  {
+                pred = succ;
+                std::swap(hp_pred, hp_succ);
+                succ = guard.protect(hp_succ, pred -> next[i]);
+                if(Reclaim::needs_validation && pred -> deleted()) goto retry;
             }
             preds[i] = pred;
             succs[i] = succ;
+            guard.hold(3 + 2 * i, pred);
+            guard.hold(4 + 2 * i, succ);
         }
-        return;
+        return top;
     }
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
     Node *_head;
     Node *_tail;
+    std::atomic<Level> _top_level{1}; //number of levels used by any tower
 
-    size_t _num_queues = 12;
-    std::vector<std::queue<Node*>> _queues{_num_queues};
-    QueueLock *_queue_locks;
+    Reclaim _reclaimer;
 
     std::atomic<size_t> _counter[COUNTER_SIZE];
 
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <algorithm>
+#include <memory>
 #include <limits>
 #include <iostream>
 #include <atomic>
@@ -11,15 +14,16 @@
 
 
 //link each level individually, shared ptr for garbage collection -> very slow
-template <class Key, class Value>
+//MaxLevel bounds the max_level given at runtime, NodeLock as in LockSkipList
+template <class Key, class Value, int MaxLevel = 64, class NodeLock = lock::Spinlock>
 class LockSkipList2
 {
 private:
     struct Node;
     using NodePtr = std::shared_ptr<Node>; //access with std::atomic_ functions 
+    using NodeArray = std::array<NodePtr, MaxLevel>; //preds and succs live on the stack
     using Level = int;
-    using Lock = lock::Spinlock;
-    // using Lock = std::mutex; //slower
+    using Lock = NodeLock;
     struct Node {
         Node(Key k, Value val, Level lev) : 
          key(k), value(val), level(lev), lock(),
@@ -38,7 +42,7 @@ private:
         std::atomic<bool> fully_linked;   //all pointers are set
     };
 public:
-    LockSkipList2(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
+    LockSkipList2(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level) {
         _head = std::make_shared<Node>(_min_key, Value(), _max_level);
         _tail = std::make_shared<Node>(_max_key, Value(), _max_level);
 
@@ -51,17 +55,14 @@ public:
     };
 
     std::pair<bool, Value> search(Key search_key) {
-        std::vector<NodePtr> preds(_max_level);
-        std::vector<NodePtr> succs(_max_level);
-        get_update_nodes(preds, succs, search_key);
-        NodePtr cur = succs[0];
+        NodePtr cur = find(search_key);
         return {cur -> key == search_key && !(cur -> beeing_deleted) && cur -> fully_linked, cur -> value};
     }
 
     void insert(Key insert_key, Value value) {
-        std::vector<NodePtr> preds(_max_level);
-        std::vector<NodePtr> succs(_max_level);
-        Level random_level = random_gen::random_level(_p, _max_level);
+        NodeArray preds, succs;
+        Level random_level = _level_gen();
+        raise_top_level(random_level); //before the descent, so preds and succs cover all levels of the new node
         get_update_nodes(preds, succs, insert_key);
         NodePtr x = succs[0];
         if(x -> key == insert_key) {
@@ -110,8 +111,7 @@ public:
     }
 
     bool remove(Key remove_key) {
-        std::vector<NodePtr> preds(_max_level);
-        std::vector<NodePtr> succs(_max_level);
+        NodeArray preds, succs;
         get_update_nodes(preds, succs, remove_key);
         NodePtr victim = succs[0];
         if(victim -> key != remove_key || !(victim -> fully_linked)) {
@@ -178,13 +178,83 @@ public:
         return v;
     }
 
+    //weakly consistent forward cursor over level 0, skips nodes that are beeing deleted or not fully linked
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            skip(_cur -> key, true);
+            return *this;
+        }
+
+    private:
+        friend class LockSkipList2;
+        Cursor(LockSkipList2 &list, Key bound, bool strict) : _tail(list._tail), _cur(list.find(bound)) {
+            skip(bound, strict);
+        }
+
+        //moves to the first visible node with key >= bound, > bound if strict
+        void skip(Key bound, bool strict) {
+            while(_cur != _tail && (_cur -> key < bound || (strict && _cur -> key == bound) || _cur -> beeing_deleted || !(_cur -> fully_linked))) {
+                _cur = std::atomic_load(&(_cur -> next[0]));
+            }
+        }
+
+        NodePtr _tail;
+        NodePtr _cur;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        return Cursor(*this, search_key, false);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        return Cursor(*this, search_key, true);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
 private:
+    //levels above the highest tower only link head to tail, the top never decreases while threads run
+    void raise_top_level(Level level) {
+        Level top = _top_level.load(std::memory_order_relaxed);
+        while(top < level && !_top_level.compare_exchange_weak(top, level)) {}
+    }
+
+    //descent without recording predecessors, stops at the first level that contains search_key
+    NodePtr find(Key search_key) {
+        NodePtr pred = std::atomic_load(&_head);
+        NodePtr succ = _tail;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            succ = std::atomic_load(&(pred -> next[i]));
+            while(succ -> key < search_key && succ != _tail)  {
+                pred = succ;
+                succ = std::atomic_load(&(succ -> next[i]));
+            }
+            if(succ -> key == search_key) {
+                return succ;
+            }
+        }
+        return succ;
+    }
+
     //returns a vector predecessors and successors, waitfree
-    void get_update_nodes(std::vector<NodePtr> &preds, std::vector<NodePtr> &succs,  Key search_key) {
+    //only levels below the current top are filled, every linked or inserting node lies below it
+    void get_update_nodes(NodeArray &preds, NodeArray &succs,  Key search_key) {
         // NodePtr pred = _head;
         NodePtr pred = std::atomic_load(&_head);
         NodePtr succ;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
             // succ = pred -> next[i];
             succ = std::atomic_load(&(pred -> next[i]));
             //2. condition for tail
@@ -202,8 +272,10 @@ private:
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
     NodePtr _head;
     NodePtr _tail;
+    std::atomic<Level> _top_level{1}; //number of levels used by any tower
 
     const Key _min_key = std::numeric_limits<Key>::min();
     const Key _max_key = std::numeric_limits<Key>::max();
@@ -1,138 +1,362 @@
 #pragma once
 
 #include <vector>
+#include <array>
+#include <cstddef>
+#include <algorithm>
 #include <limits>
 #include <iostream>
 #include <atomic>
 #include <memory>
+#include <new>
 #include <mutex>
+#include <tuple>
 
 #include "implementation/spinlock.hpp"
 #include "implementation/markable_reference.hpp"
+#include "implementation/reclamation.hpp"
+#include "implementation/node_pool.hpp"
+#include "implementation/bulk_load.hpp"
 #include "random_generator.hpp"
 
 #define COUNTER_SIZE 100
+#define MULTI_SEARCH_GROUP 16 //traversals in flight in multi_search
 
-template <class Key, class Value, bool do_count = false>
+//MaxLevel bounds the max_level given at runtime
+template <class Key, class Value, bool do_count = false, template<class> class Reclaimer = reclamation::EpochBased, int MaxLevel = 64>
 class LockFreeSkipList
 {
 private:
     struct Node;
     using Level = int;
     using MarkPtr = pointer::MarkableReference<Node>;
-    using QueueLock = lock::Spinlock;
-    // using QueueLock = std::mutex;
-    struct Node {
+    using Reclaim = Reclaimer<Node>;
+    using Guard = typename Reclaim::Guard;
+    using NodeArray = std::array<Node*, MaxLevel>; //preds and succs live on the stack
+    //tower is stored inline behind the node, one cache line aligned block per node from the node pool
+    struct alignas(64) Node {
         Node(Key k, Value val, Level lev) : 
-         key(k), value(val), level(lev) {
-             next = new std::atomic<MarkPtr>[level];
+         level(lev), value(val), key(k) {
+             for(Level i = 0; i < level; ++i) {
+                 new (&next[i]) std::atomic<MarkPtr>();
+             }
          };
-        ~Node() {
-            delete next;
+        //the block ends with the tower, the padding of the aligned struct is not allocated
+        static void* operator new(size_t, Level lev) {
+            return pool::NodePool<Node>::allocate(offsetof(Node, next) + lev * sizeof(std::atomic<MarkPtr>), lev);
         }
-        std::atomic<Key> key;
-        std::atomic<Value> value;
-        std::atomic<MarkPtr> *next; //mark all pointers from node, that should be removed
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level;
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+
         Level level;
+        std::atomic<int> pending{2}; //inserter and remover, the last one to finish retires the node
+        std::atomic<Value> value;
+        std::atomic<Key> key; //next to next[0], read together on every hop
+        std::atomic<MarkPtr> next[]; //mark all pointers from node, that should be removed
     };
     
 public:
-    LockFreeSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
-        _head = new Node(std::numeric_limits<Key>::min(), Value(), _max_level);
-        _tail = new Node(std::numeric_limits<Key>::max(), Value(), _max_level);
+    LockFreeSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level), _reclaimer(_max_level) {
+        _head = new (_max_level) Node(std::numeric_limits<Key>::min(), Value(), _max_level);
+        _tail = new (_max_level) Node(std::numeric_limits<Key>::max(), Value(), _max_level);
         for(int i = 0; i < _max_level; ++i) {
             _head -> next[i] = _tail;
         }
         for(int i = 0; i < _max_level; ++i) {
             _tail -> next[i] = _tail; //safety
         }
-        _queue_locks = new QueueLock[_num_queues];
     };
 
-    ~LockFreeSkipList() {
-        for(auto &q : _queues) {
-            while(!q.empty()) {
-                auto ptr = q.front(); q.pop();
-                delete ptr;
-            }
-        }
-        delete _queue_locks;
+    //bulk load from a random access range of (key, value) pairs sorted by unique keys, O(n) and parallel with OpenMP
+    template<class Iterator>
+    LockFreeSkipList(const double &probability, const Level &max_level, Iterator first, Iterator last) : LockFreeSkipList(probability, max_level) {
+        bulk_load(first, last);
     }
 
     std::pair<bool, Value> search(Key search_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, search_key);
-        Node *cur = succs[0];
+        auto guard = _reclaimer.enter();
+        Node *cur;
+        //hazard pointers can not protect marked nodes, unlink them on the way
+        if constexpr(Reclaim::needs_validation) {
+            NodeArray preds, succs;
+            get_update_nodes(guard, preds, succs, search_key);
+            cur = succs[0];
+        }
+        else {
+            cur = find(search_key);
+        }
         return {cur -> key == search_key, cur -> value};
     }
 
-    void insert(Key insert_key, Value value) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        Level random_level = random_gen::random_level(_p, _max_level);
-        get_update_nodes(preds, succs, insert_key);
-        Node* x = succs[0];
-        if(x -> key == insert_key) {
-            x -> value = value;
+    //lookups for a batch of keys, results[i] = search(keys[i])
+    //a group of traversals advances one hop per turn and prefetches its next node, so their cache misses overlap
+    //hazard pointers protect a single traversal per guard, there each key is searched on its own
+    void multi_search(const std::vector<Key> &keys, std::vector<std::pair<bool, Value>> &results) {
+        results.resize(keys.size());
+        if constexpr(Reclaim::needs_validation) {
+            for(size_t i = 0; i < keys.size(); ++i) {
+                results[i] = search(keys[i]);
+            }
             return;
         }
-        Node* new_node = new Node(insert_key, value, random_level);
-        auto try_link_at = [&](int j) {
-            MarkPtr expect = {succs[j], false};
-            return preds[j] -> next[j].compare_exchange_strong(expect, {new_node, false});
+        [[maybe_unused]] auto guard = _reclaimer.enter(); //keeps visited nodes alive for all traversals
+        struct Traversal {
+            size_t index;
+            Level level;
+            Node *pred, *cur;
         };
-        while(true) {
-            for(Level lev = 0; lev < random_level; ++lev) {
-               new_node -> next[lev] = {succs[lev], false};
-            }
-            if(succs[0] -> key == insert_key) {
-                delete new_node;
-                return; //other thread inserted it
-            }
-            if(try_link_at(0)) {
-                break;
-            }
-            get_update_nodes(preds, succs, insert_key);
+        std::array<Traversal, MULTI_SEARCH_GROUP> group;
+        size_t next_key = 0, active = 0;
+        auto start = [&](Traversal &t) {
+            t.index = next_key++;
+            t.level = _top_level.load() - 1;
+            t.pred = _head;
+            t.cur = _head -> next[t.level].load().getRef();
+            __builtin_prefetch(t.cur);
+        };
+        for(; active < MULTI_SEARCH_GROUP && next_key < keys.size(); ++active) {
+            start(group[active]);
         }
-        for(Level lev = 1; lev < random_level; ++lev) {
-            while(!try_link_at(lev)) {
-                get_update_nodes(preds, succs, insert_key);
+        //same steps as find, one node per turn
+        while(active > 0) {
+            for(size_t g = 0; g < active;) {
+                Traversal &t = group[g];
+                Key search_key = keys[t.index];
+                Node *cur = t.cur;
+                MarkPtr succ = cur -> next[t.level];
+                if(succ.getMark()) {
+                    t.cur = succ.getRef();
+                }
+                else if(cur -> key < search_key) {
+                    t.pred = cur;
+                    t.cur = succ.getRef();
+                }
+                else if(cur -> key != search_key && t.level > 0) {
+                    t.cur = t.pred -> next[--t.level].load().getRef();
+                }
+                else {
+                    results[t.index] = {cur -> key == search_key, cur -> value};
+                    if(next_key == keys.size()) {
+                        t = group[--active];
+                        continue;
+                    }
+                    start(t);
+                }
+                __builtin_prefetch(t.cur);
+                ++g;
             }
         }
     }
 
+    void insert(Key insert_key, Value value) {
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        Level random_level = _level_gen();
+        raise_top_level(random_level); //before the descent, so preds and succs cover all levels of the new node
+        get_update_nodes(guard, preds, succs, insert_key);
+        link(guard, preds, succs, insert_key, value, random_level);
+    }
+
+    //per thread finger on the path of its last operation, the next one climbs from there instead of descending from head
+    //O(log d) steps for a key at distance d from the previous one
+    //keeps a guard while it lives, so remembered nodes can not be reclaimed, drop it between bursts of nearby accesses
+    class Finger {
+    private:
+        friend class LockFreeSkipList;
+        Finger(LockFreeSkipList &list) : _guard(list._reclaimer.enter()) {}
+
+        Guard _guard;
+        NodeArray _preds, _succs;
+        Level _top = 0; //preds and succs are filled below this level
+    };
+
+    Finger finger() {
+        return Finger(*this);
+    }
+
+    std::pair<bool, Value> search(Finger &finger, Key search_key) {
+        finger._top = resume_update_nodes(finger._guard, finger._preds, finger._succs, search_key, finger._top);
+        Node *cur = finger._succs[0];
+        return {cur -> key == search_key, cur -> value};
+    }
+
+    void insert(Finger &finger, Key insert_key, Value value) {
+        Level random_level = _level_gen();
+        raise_top_level(random_level);
+        finger._top = resume_update_nodes(finger._guard, finger._preds, finger._succs, insert_key, finger._top);
+        link(finger._guard, finger._preds, finger._succs, insert_key, value, random_level);
+    }
+
+    //range of (key, value) pairs in ascending key order, each key resumes the path of the previous one
+    template<class Iterator>
+    void insert_batch(Iterator first, Iterator last) {
+        Finger path(*this);
+        for(; first != last; ++first) {
+            insert(path, first -> first, first -> second);
+        }
+    }
+
     //returns if element was in list and is in the process of beeing removed
     bool remove(Key remove_key) {
-        std::vector<Node*> preds(_max_level);
-        std::vector<Node*> succs(_max_level);
-        get_update_nodes(preds, succs, remove_key);
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        get_update_nodes(guard, preds, succs, remove_key);
         Node *victim = succs[0];
         if(victim -> key != remove_key) {
             return false;
         }
-        Level node_level = victim -> level;
-        bool i_marked_last = false;
-        //mark outgoing pointer of victim
-        for(Level lv = node_level - 1; lv >= 0; --lv) {
-            MarkPtr next_node = victim -> next[lv].load();
-            while(!next_node.getMark()) {
-                Node *ref = next_node.getRef();
-                MarkPtr expect = {ref, false};
-                bool marked_it = victim -> next[lv].compare_exchange_weak(expect, {ref, true});
-                if(lv == 0 && marked_it) i_marked_last = true;
-                next_node = victim -> next[lv].load();
+        bool i_marked_last = mark_tower(victim);
+        //ensure element is only retired once, inserter might still link upper levels
+        bool last = i_marked_last && victim -> pending.fetch_sub(1) == 1;
+        get_update_nodes(guard, preds, succs, remove_key); //deleted marked nodes
+        if(last) {
+            guard.retire(victim);
+        }
+        return true;
+    }
+
+    //smallest element, without removing it
+    std::tuple<bool, Key, Value> peek_min() {
+        auto guard = _reclaimer.enter();
+        Node *cur;
+        if constexpr(Reclaim::needs_validation) {
+            NodeArray preds, succs;
+            get_update_nodes(guard, preds, succs, _min_key); //unlinks the deleted prefix
+            cur = succs[0];
+        }
+        else {
+            cur = first_unmarked(_head -> next[0].load().getRef());
+        }
+        if(cur == _tail) {
+            return {false, Key(), Value()};
+        }
+        return {true, cur -> key, cur -> value};
+    }
+
+    //removes the smallest element, the first node whose level 0 pointer this thread marks
+    //every pop unlinks its node, so all threads CAS at the head
+    std::tuple<bool, Key, Value> pop_min() {
+        auto guard = _reclaimer.enter();
+        NodeArray preds, succs;
+        while(true) {
+            get_update_nodes(guard, preds, succs, _min_key); //unlinks the deleted prefix
+            Node *victim = succs[0];
+            if(victim == _tail) {
+                return {false, Key(), Value()};
+            }
+            if(!mark_tower(victim)) {
+                continue; //other thread took it
             }
+            Key key = victim -> key;
+            Value value = victim -> value;
+            bool last = victim -> pending.fetch_sub(1) == 1;
+            get_update_nodes(guard, preds, succs, key);
+            if(last) {
+                guard.retire(victim);
+            }
+            return {true, key, value};
         }
-        get_update_nodes(preds, succs, remove_key); //deleted marked nodes
-        //ensure element is only pushed once into garbage queue
-        if(i_marked_last) {
-            size_t index = random_gen::random_index(_num_queues);
-            _queue_locks[index].lock();
-            _queues[index].push(victim);
-            _queue_locks[index].unlock();
+    }
+
+    //per thread handle for pop_min with batched physical deletion
+    //popped nodes stay linked as a growing deleted prefix, a thread that walks past bound of them moves the head
+    //past the whole prefix with a single CAS per level, nodes this handle has to retire are freed bound at a time
+    class PopBatch {
+    public:
+        ~PopBatch() {
+            _list.flush(*this);
         }
-        return true;
+
+        //owns its claimed nodes, a copy would retire them twice
+        PopBatch(const PopBatch&) = delete;
+        PopBatch& operator=(const PopBatch&) = delete;
+    private:
+        friend class LockFreeSkipList;
+        PopBatch(LockFreeSkipList &list, size_t bound) : _list(list), _bound(bound) {}
+
+        LockFreeSkipList &_list;
+        const size_t _bound;
+        std::vector<Node*> _popped; //marked by this handle, unlinked and retired on the next flush
+    };
+
+    PopBatch pop_batch(size_t bound = 64) {
+        return PopBatch(*this, bound);
+    }
+
+    //hazard pointers can not walk over marked nodes, there every pop unlinks like pop_min()
+    std::tuple<bool, Key, Value> pop_min(PopBatch &batch) {
+        if constexpr(Reclaim::needs_validation) {
+            return pop_min();
+        }
+        [[maybe_unused]] auto guard = _reclaimer.enter(); //keeps the deleted prefix alive
+        Node *cur = _head -> next[0].load().getRef();
+        size_t skipped = 0;
+        while(cur != _tail) {
+            if(cur -> next[0].load().getMark()) {
+                cur = cur -> next[0].load().getRef();
+                skipped++;
+                continue;
+            }
+            if(!mark_tower(cur)) {
+                continue; //other thread took it, its pointer is marked now
+            }
+            Key key = cur -> key;
+            Value value = cur -> value;
+            claimed(batch, cur, skipped);
+            return {true, key, value};
+        }
+        return {false, Key(), Value()};
+    }
+
+    //relaxed pop_min for schedulers (SprayList), a random walk over the top levels lands on one of the first O(p log^3 p) elements
+    //p = num_threads: start height log p + 1, jumps of up to log^3 p nodes, log log p levels down per jump
+    //threads that land on a taken node spray again, after a few misses or on a nearly empty list they pop the minimum
+    std::tuple<bool, Key, Value> spray_pop(PopBatch &batch, int num_threads) {
+        if constexpr(Reclaim::needs_validation) {
+            return pop_min();
+        }
+        const int log_p = 31 - __builtin_clz(std::max(num_threads, 1));
+        if(log_p == 0) {
+            return pop_min(batch);
+        }
+        const uint64_t max_jump = uint64_t(log_p) * log_p * log_p;
+        const Level descent = std::max(1, 31 - __builtin_clz(log_p));
+        [[maybe_unused]] auto guard = _reclaimer.enter(); //marked nodes on the walk stay readable
+        for(int attempt = 0; attempt < 4; ++attempt) {
+            Node *cur = _head;
+            for(Level lv = std::min<Level>(log_p + 1, _top_level.load()) - 1; ; lv = std::max(lv - descent, 0)) {
+                for(uint64_t jump = random_gen::next() % (max_jump + 1); jump > 0; --jump) {
+                    Node *next = cur -> next[lv].load().getRef();
+                    if(next == _tail) break;
+                    cur = next;
+                }
+                if(lv == 0) break;
+            }
+            if(cur == _head) {
+                cur = _head -> next[0].load().getRef();
+            }
+            size_t skipped = 0;
+            while(cur != _tail && cur -> next[0].load().getMark()) {
+                cur = cur -> next[0].load().getRef();
+                skipped++;
+            }
+            if(cur == _tail) {
+                break; //fewer elements than the spray width
+            }
+            if(!mark_tower(cur)) {
+                continue;
+            }
+            Key key = cur -> key;
+            Value value = cur -> value;
+            claimed(batch, cur, skipped);
+            return {true, key, value};
+        }
+        return pop_min(batch);
     }
 
     bool is_consistent() {
@@ -164,6 +388,75 @@ public:
         return v;
     }
 
+    //weakly consistent forward cursor over level 0, skips marked nodes
+    //holds a guard of the reclamation policy for its whole lifetime, keep it short lived
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _list._tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            skip(_cur -> key, true);
+            return *this;
+        }
+
+    private:
+        friend class LockFreeSkipList;
+        Cursor(LockFreeSkipList &list, Key bound, bool strict) : _list(list), _guard(list._reclaimer.enter()) {
+            seek(bound);
+            skip(bound, strict);
+        }
+
+        void seek(Key bound) {
+            //hazard pointers can not protect marked nodes, unlink them on the way
+            if constexpr(Reclaim::needs_validation) {
+                NodeArray preds, succs;
+                _list.get_update_nodes(_guard, preds, succs, bound);
+                _cur = succs[0];
+            }
+            else {
+                _cur = _list.find(bound);
+            }
+        }
+
+        //moves to the first unmarked node with key >= bound, > bound if strict
+        void skip(Key bound, bool strict) {
+            while(_cur != _list._tail && (_cur -> key < bound || (strict && _cur -> key == bound) || _cur -> next[0].load().getMark())) {
+                MarkPtr succ = _guard.protect(0, _cur -> next[0]);
+                //removed node might point to reclaimed nodes, search again from its key
+                if(Reclaim::needs_validation && succ.getMark()) {
+                    seek(_cur -> key);
+                    continue;
+                }
+                _guard.hold(_hp_cur, succ.getRef());
+                _cur = succ.getRef();
+            }
+        }
+
+        static constexpr int _hp_cur = 4; //get_update_nodes leaves succs[0] there
+        LockFreeSkipList &_list;
+        Guard _guard;
+        Node *_cur;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        return Cursor(*this, search_key, false);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        return Cursor(*this, search_key, true);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
     void init_counter() {
         for(int i = 0; i < COUNTER_SIZE; ++i) {
             _counter1[i] = 0;
@@ -182,17 +475,222 @@ public:
     }
 
 private:
-    //returns a vector predecessors and successors, waitfree
-    void get_update_nodes(std::vector<Node*> &preds, std::vector<Node*> &succs,  Key search_key) {
+    //towers follow bulk::Layout, nodes are created and linked in two independent parallel loops
+    template<class Iterator>
+    void bulk_load(Iterator first, Iterator last) {
+        const size_t n = last - first;
+        bulk::Layout layout(_p, _max_level, n);
+        std::vector<Node*> nodes(n + 2);
+        nodes[0] = _head;
+        nodes[n + 1] = _tail;
+        #pragma omp parallel for
+        for(size_t i = 1; i <= n; ++i) {
+            Level level = layout.level(i);
+            nodes[i] = new (level) Node(first[i - 1].first, first[i - 1].second, level);
+            nodes[i] -> pending = 1; //only a remover is left to finish
+        }
+        #pragma omp parallel for
+        for(size_t i = 0; i <= n; ++i) {
+            for(Level l = 0; l < nodes[i] -> level; ++l) {
+                nodes[i] -> next[l] = {nodes[layout.next(i, l)], false};
+            }
+        }
+        _top_level = layout.top();
+    }
+
+    //links a new node between preds and succs, refreshes them on conflicts
+    //afterwards preds holds the new node on its levels unless it was removed meanwhile
+    void link(Guard &guard, NodeArray &preds, NodeArray &succs, Key insert_key, Value value, Level random_level) {
+        Node* x = succs[0];
+        if(x -> key == insert_key) {
+            x -> value = value;
+            return;
+        }
+        Node* new_node = new (random_level) Node(insert_key, value, random_level);
+        auto try_link_at = [&](int j) {
+            MarkPtr expect = {succs[j], false};
+            return preds[j] -> next[j].compare_exchange_strong(expect, {new_node, false});
+        };
+        while(true) {
+            for(Level lev = 0; lev < random_level; ++lev) {
+               new_node -> next[lev] = {succs[lev], false};
+            }
+            if(succs[0] -> key == insert_key) {
+                delete new_node;
+                return; //other thread inserted it
+            }
+            if(try_link_at(0)) {
+                break;
+            }
+            get_update_nodes(guard, preds, succs, insert_key);
+        }
+        //a concurrent remove may mark the new node while upper levels are linked, then stop linking
+        bool marked = false;
+        for(Level lev = 1; lev < random_level && !marked; ++lev) {
+            while(true) {
+                MarkPtr old_next = new_node -> next[lev];
+                //successors can change between retries, only a remover marks this pointer
+                if(old_next.getMark() || (old_next.getRef() != succs[lev] &&
+                   !new_node -> next[lev].compare_exchange_strong(old_next, {succs[lev], false}))) {
+                    marked = true;
+                    break;
+                }
+                if(try_link_at(lev)) {
+                    break;
+                }
+                get_update_nodes(guard, preds, succs, insert_key);
+            }
+        }
+        //the path continues behind the new node, it is not retired before pending drops
+        for(Level lev = 0; lev < random_level && !marked; ++lev) {
+            preds[lev] = new_node;
+            guard.hold(3 + 2 * lev, new_node);
+        }
+        if(new_node -> pending.fetch_sub(1) == 1) {
+            get_update_nodes(guard, preds, succs, insert_key); //remover finished first, unlink levels linked since
+            guard.retire(new_node);
+        }
+    }
+
+    //marks the tower top-down, true for the thread that marks level 0 and so removes the node
+    bool mark_tower(Node *victim) {
+        bool i_marked_last = false;
+        for(Level lv = victim -> level - 1; lv >= 0; --lv) {
+            MarkPtr next_node = victim -> next[lv].load();
+            while(!next_node.getMark()) {
+                Node *ref = next_node.getRef();
+                MarkPtr expect = {ref, false};
+                bool marked_it = victim -> next[lv].compare_exchange_weak(expect, {ref, true});
+                if(lv == 0 && marked_it) i_marked_last = true;
+                next_node = victim -> next[lv].load();
+            }
+        }
+        return i_marked_last;
+    }
+
+    //walks level 0 over marked nodes, only without hazard pointers
+    Node* first_unmarked(Node *cur) {
+        while(cur != _tail && cur -> next[0].load().getMark()) {
+            cur = cur -> next[0].load().getRef();
+        }
+        return cur;
+    }
+
+    //the inserter might still link upper levels, then it unlinks and retires the node itself
+    void claimed(PopBatch &batch, Node *node, size_t skipped) {
+        if(node -> pending.fetch_sub(1) == 1) {
+            batch._popped.push_back(node);
+        }
+        if(batch._popped.size() >= batch._bound) {
+            flush(batch);
+        }
+        else if(skipped >= batch._bound) {
+            skip_prefix();
+        }
+    }
+
+    //pointers of marked nodes never change, so the head can skip a whole chain of them with one CAS per level
+    void skip_prefix() {
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            Node *first = _head -> next[i].load().getRef();
+            Node *cur = first;
+            while(cur != _tail && cur -> next[i].load().getMark()) {
+                cur = cur -> next[i].load().getRef();
+            }
+            if(cur != first) {
+                MarkPtr expect = {first, false};
+                _head -> next[i].compare_exchange_strong(expect, {cur, false});
+            }
+        }
+    }
+
+    //unlinks everything the handle popped, nodes behind newer small keys or sprayed from the middle need their own descent
+    //in ascending key order each descent resumes the path of the previous one
+    void flush(PopBatch &batch) {
+        if(batch._popped.empty()) return;
+        auto guard = _reclaimer.enter();
+        skip_prefix();
+        std::sort(batch._popped.begin(), batch._popped.end(), [](Node *a, Node *b) { return a -> key < b -> key; });
+        NodeArray preds, succs;
+        Level top = 0;
+        for(Node *node : batch._popped) {
+            top = resume_update_nodes(guard, preds, succs, node -> key, top);
+        }
+        for(Node *node : batch._popped) {
+            guard.retire(node);
+        }
+        batch._popped.clear();
+    }
+
+    //levels above the highest tower only link head to tail, the top never decreases while threads run
+    void raise_top_level(Level level) {
+        Level top = _top_level.load(std::memory_order_relaxed);
+        while(top < level && !_top_level.compare_exchange_weak(top, level)) {}
+    }
+
+    //waitfree descent that skips marked nodes instead of unlinking them, stops at the first level that contains search_key
+    //only used if retired nodes stay readable until the guard is released
+    Node* find(Key search_key) {
+        if constexpr(do_count) _counter1[random_gen::random_index(COUNTER_SIZE)]++; //special metric
+        Node *pred = _head;
+        Node *cur = nullptr;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            cur = pred -> next[i].load().getRef();
+            while(true) {
+                MarkPtr succ = cur -> next[i];
+                while(succ.getMark()) {
+                    cur = succ.getRef();
+                    succ = cur -> next[i];
+                }
+                if(cur -> key < search_key) {
+                    pred = cur;
+                    cur = succ.getRef();
+                }
+                else {
+                    break;
+                }
+            }
+            if(cur -> key == search_key) {
+                return cur;
+            }
+        }
+        return cur;
+    }
+
+    //climbs the previous path to the lowest level whose pred lies before search_key and whose successor is not overtaken
+    //keeps the levels above and walks on from that pred, returns the number of filled levels
+    //a removed pred can link past newer nodes, then the descent starts at head
+    Level resume_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs, Key search_key, Level path_top) {
+        Level start = 0;
+        while(start < path_top && !(preds[start] -> key < search_key && search_key <= succs[start] -> key)) start++;
+        if(path_top != _top_level.load() || start == path_top || preds[start] -> next[start].load().getMark()) {
+            return get_update_nodes(guard, preds, succs, search_key);
+        }
+        return get_update_nodes(guard, preds, succs, search_key, start + 1, path_top);
+    }
+
+    //returns a vector predecessors and successors and the number of filled levels, waitfree
+    //only levels below the current top are filled, every linked or inserting node lies below it
+    //with resume > 0 the levels from resume up to path_top are kept and the descent walks on from preds[resume - 1]
+    //preds and succs stay protected by the guard until the next call
+    Level get_update_nodes(Guard &guard, NodeArray &preds, NodeArray &succs,  Key search_key, Level resume = 0, Level path_top = 0) {
         if constexpr(do_count) _counter1[random_gen::random_index(COUNTER_SIZE)]++; //special metric
         bool snip = false;
         MarkPtr pred, cur, succ;
+        Level top, from;
+        int hp_pred, hp_cur, hp_succ; //rotating hazard indices
         retry:
-        pred = {_head, false};
-        for(int i = _max_level - 1; i >= 0; --i) {
-            cur = pred -> next[i];
+        top = resume > 0 ? path_top : _top_level.load();
+        from = resume > 0 ? resume : top;
+        pred = {resume > 0 ? preds[resume - 1] : _head, false};
+        resume = 0; //retries begin at head
+        hp_pred = 0, hp_cur = 1, hp_succ = 2;
+        for(int i = from - 1; i >= 0; --i) {
+            cur = guard.protect(hp_cur, pred -> next[i]);
+            //pred is removed at this level, cur might already be reclaimed
+            if(Reclaim::needs_validation && cur.getMark()) goto retry;
             while(true) {
-                succ = cur -> next[i];
+                succ = guard.protect(hp_succ, cur -> next[i]);
                 while(succ.getMark()) {
                     MarkPtr expect = {cur.getRef(), false};
                     // lazy removal of marked nodes
@@ -201,12 +699,14 @@ private:
                         if constexpr(do_count) _counter2[random_gen::random_index(COUNTER_SIZE)]++; //special metric
                         goto retry;     
                     }
-                    cur = pred -> next[i];
-                    succ = cur -> next[i];
+                    cur = guard.protect(hp_cur, pred -> next[i]);
+                    if(Reclaim::needs_validation && cur.getMark()) goto retry;
+                    succ = guard.protect(hp_succ, cur -> next[i]);
                 }
                 if(cur -> key < search_key) {
                     pred = cur;
                     cur = succ;
+                    std::tie(hp_pred, hp_cur, hp_succ) = std::make_tuple(hp_cur, hp_succ, hp_pred);
                 }
                 else {
                     break;
@@ -214,18 +714,20 @@ private:
             }
             preds[i] = pred.getRef();
             succs[i] = cur.getRef();
+            guard.hold(3 + 2 * i, preds[i]);
+            guard.hold(4 + 2 * i, succs[i]);
         }
-        return;
+        return top;
     }
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
     Node* _head;
     Node* _tail;
+    std::atomic<Level> _top_level{1}; //number of levels used by any tower
 
-    size_t _num_queues = 12;
-    std::vector<std::queue<Node*>> _queues{_num_queues};
-    QueueLock *_queue_locks;
+    Reclaim _reclaimer;
 
     std::atomic<size_t> _counter1[COUNTER_SIZE];
     std::atomic<size_t> _counter2[COUNTER_SIZE];
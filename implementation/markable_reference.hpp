@@ -18,5 +18,6 @@ namespace pointer {
         T* getRef() const { return (T*)(val & ~mask); }
         bool getMark() const { return (val & mask); }
         T *operator->() const { return (T*)(val & ~mask); }
+        bool operator==(const MarkableReference &other) const { return val == other.val; }
     };
 }
\ No newline at end of file
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <new>
+#include <vector>
+#include <cstddef>
+
+#include "implementation/spinlock.hpp"
+
+namespace pool {
+    //size class allocator for nodes with inline towers, one size class per tower height
+    //every thread caches free blocks, batches of blocks move between the caches and a shared pool
+    //memory is kept by the pool until the program ends
+    template<class Node>
+    class NodePool {
+    private:
+        static constexpr int _num_classes = 64; //higher towers use the global allocator
+        static constexpr size_t _batch = 64; //blocks moved between a thread cache and the shared pool
+        static constexpr size_t _chunk_blocks = 256; //blocks carved from one chunk of fresh memory
+        static constexpr std::align_val_t _align{alignof(Node)};
+
+        struct FreeBlock {
+            FreeBlock *next;
+        };
+
+        struct Shared {
+            ~Shared() {
+                for(auto chunk : chunks) {
+                    ::operator delete(chunk, _align);
+                }
+            }
+            lock::Spinlock locks[_num_classes];
+            std::vector<FreeBlock*> batches[_num_classes]; //linked lists of free blocks
+            std::vector<void*> chunks;
+            lock::Spinlock chunk_lock;
+        };
+
+        struct Cache {
+            ~Cache() {
+                for(int c = 0; c < _num_classes; ++c) {
+                    if(head[c] != nullptr) {
+                        give_back(c, head[c]);
+                    }
+                }
+            }
+            FreeBlock *head[_num_classes] = {};
+            size_t count[_num_classes] = {};
+        };
+
+        static Shared& shared() {
+            static Shared s;
+            return s;
+        }
+
+        static Cache& cache() {
+            static thread_local Cache c;
+            return c;
+        }
+
+        static void give_back(int c, FreeBlock *list) {
+            Shared &s = shared();
+            s.locks[c].lock();
+            s.batches[c].push_back(list);
+            s.locks[c].unlock();
+        }
+
+        //takes a batch from the shared pool or carves a new chunk
+        static void refill(Cache &cache, int c, size_t bytes) {
+            Shared &s = shared();
+            s.locks[c].lock();
+            if(!s.batches[c].empty()) {
+                FreeBlock *list = s.batches[c].back();
+                s.batches[c].pop_back();
+                s.locks[c].unlock();
+                size_t n = 0;
+                for(FreeBlock *b = list; b != nullptr; b = b -> next) n++;
+                cache.head[c] = list;
+                cache.count[c] = n;
+                return;
+            }
+            s.locks[c].unlock();
+            size_t block_size = round_up(bytes);
+            char *chunk = static_cast<char*>(::operator new(block_size * _chunk_blocks, _align));
+            s.chunk_lock.lock();
+            s.chunks.push_back(chunk);
+            s.chunk_lock.unlock();
+            FreeBlock *list = nullptr;
+            for(size_t i = _chunk_blocks; i > 0; --i) {
+                FreeBlock *b = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * block_size);
+                b -> next = list;
+                list = b;
+            }
+            cache.head[c] = list;
+            cache.count[c] = _chunk_blocks;
+        }
+
+        static size_t round_up(size_t bytes) {
+            size_t align = alignof(Node) < sizeof(FreeBlock) ? sizeof(FreeBlock) : alignof(Node);
+            return (bytes + align - 1) / align * align;
+        }
+
+    public:
+        //bytes must be the same for all nodes of one level
+        static void* allocate(size_t bytes, int level) {
+            if(level > _num_classes) {
+                return ::operator new(bytes, _align);
+            }
+            int c = level - 1;
+            Cache &local = cache();
+            if(local.head[c] == nullptr) {
+                refill(local, c, bytes);
+            }
+            FreeBlock *b = local.head[c];
+            local.head[c] = b -> next;
+            local.count[c]--;
+            return b;
+        }
+
+        static void deallocate(void *ptr, int level) {
+            if(level > _num_classes) {
+                ::operator delete(ptr, _align);
+                return;
+            }
+            int c = level - 1;
+            Cache &local = cache();
+            FreeBlock *b = static_cast<FreeBlock*>(ptr);
+            b -> next = local.head[c];
+            local.head[c] = b;
+            local.count[c]++;
+            //keep one batch locally, hand the rest to other threads
+            if(local.count[c] >= 2 * _batch) {
+                FreeBlock *last = b;
+                for(size_t i = 1; i < _batch; ++i) last = last -> next;
+                local.head[c] = last -> next;
+                last -> next = nullptr;
+                local.count[c] -= _batch;
+                give_back(c, b);
+            }
+        }
+    };
+}
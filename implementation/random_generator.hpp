@@ -1,6 +1,10 @@
 #pragma once
 #include <random>
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <cmath>
+#include <cstdint>
 
 namespace random_gen {
 
@@ -24,6 +28,7 @@ namespace random_gen {
         return dist(gen) <= p;
     }
 
+    //one draw per level, the skiplists use LevelGenerator
     int random_level(const double &p, const int &max_level) {
         int level = 1;
         while(prob_p(p) && level < max_level) level++;
@@ -57,12 +62,46 @@ namespace random_gen {
         }
     }
 
-    static uint64_t s[2] = { 0x41, 0x29837592 };
+    //xoroshiro128+ state, one per thread
+    struct FastState {
+        uint64_t s[2];
+        uint64_t generation; //seed generation the state was derived from
+    };
+
+    //deterministic seeding, 0 means seeded from std::random_device
+    inline std::atomic<uint64_t> seed_value{0};
+    inline std::atomic<uint64_t> seed_generation{1};
+    inline std::atomic<uint64_t> thread_ordinal{0};
+
+    static inline uint64_t splitmix64(uint64_t &x) {
+        uint64_t z = (x += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    //reproducible benchmarks: threads derive their state from value and the order in which they first draw after this call
+    inline void seed(uint64_t value) {
+        seed_value = value;
+        thread_ordinal = 0;
+        seed_generation++;
+    }
+
     static inline uint64_t rotl(const uint64_t x, int k) {
         return (x << k) | (x >> (64 - k));
     }
 
-    uint64_t next(void) {
+    inline uint64_t next(void) {
+        static thread_local FastState state = {{0, 0}, 0};
+        uint64_t *s = state.s;
+        uint64_t generation = seed_generation.load(std::memory_order_relaxed);
+        if(state.generation != generation) {
+            uint64_t base = seed_value.load();
+            uint64_t x = base != 0 ? base + thread_ordinal.fetch_add(1) : (uint64_t(std::random_device{}()) << 32) ^ std::random_device{}();
+            s[0] = splitmix64(x);
+            s[1] = splitmix64(x);
+            state.generation = generation;
+        }
         const uint64_t s0 = s[0];
         uint64_t s1 = s[1];
         const uint64_t result = s0 + s1;
@@ -76,9 +115,47 @@ namespace random_gen {
         return next() & 1;
     }
 
+    //p = 1/2
     int fast_random_level(const int &max_level) {
-        int level = 1;
-        while(fast_prob_p() && level < max_level) level++;
-        return level;
+        int level = 1 + __builtin_ctzll(next() | (uint64_t(1) << 63));
+        return std::min(level, max_level);
     }
+
+    //level from a single 64 bit draw, immutable after construction and shared by all threads
+    //p = 2^-k: every k trailing zero bits add one level
+    //other p: level - 1 = number of thresholds p^l * 2^64 above the draw, usually one or two compares
+    class LevelGenerator {
+    public:
+        LevelGenerator(const double &p, const int &max_level) : _max_level(std::max(1, std::min(max_level, 64))) {
+            if(p > 0 && p < 1) {
+                int k = static_cast<int>(std::lround(-std::log2(p)));
+                if(k >= 1 && k < 64 && std::ldexp(1.0, -k) == p) {
+                    _shift = k;
+                }
+            }
+            double threshold = 1;
+            for(int l = 0; l < 64; ++l) {
+                threshold *= p;
+                //p^l * 2^64, saturated at both ends
+                double scaled = std::ldexp(threshold, 64);
+                _thresholds[l] = scaled >= 18446744073709551615.0 ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(scaled);
+            }
+        }
+
+        int operator()() const {
+            uint64_t x = next();
+            if(_shift != 0) {
+                int level = 1 + __builtin_ctzll(x | (uint64_t(1) << 63)) / _shift;
+                return std::min(level, _max_level);
+            }
+            int level = 1;
+            while(level < _max_level && x < _thresholds[level - 1]) level++;
+            return level;
+        }
+
+    private:
+        int _max_level;
+        int _shift = 0; //k if p = 2^-k
+        uint64_t _thresholds[64]; //_thresholds[l] = p^(l+1) * 2^64
+    };
 }
\ No newline at end of file
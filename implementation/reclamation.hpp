@@ -0,0 +1,302 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <type_traits>
+
+#include "implementation/spinlock.hpp"
+#include "random_generator.hpp"
+
+//reclamation policies for the concurrent skiplists, used as template template parameter Reclaimer<Node>
+//operations hold a Guard, read shared pointers with protect and hand unlinked nodes to retire
+namespace reclamation {
+    //starting slot of the calling thread, threads keep the slot of their last operation
+    inline size_t& slot_hint() {
+        static thread_local size_t hint = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return hint;
+    }
+
+    template<class Node, class Ptr>
+    Node* raw_pointer(const Ptr &ptr) {
+        if constexpr(std::is_pointer_v<Ptr>) return ptr;
+        else return ptr.getRef();
+    }
+
+    //original scheme, removed nodes are parked in queues and freed when the skiplist is destroyed
+    //pass another QueueLock through an alias template, e.g. template<class N> using Q = GarbageQueues<N, lock::BackoffSpinlock<>>
+    template<class Node, class QueueLock = lock::Spinlock>
+    class GarbageQueues {
+    public:
+        static constexpr bool needs_validation = false;
+
+        class Guard {
+        public:
+            Guard(GarbageQueues &domain) : _domain(domain) {}
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+            template<class Ptr>
+            Ptr protect(int, const std::atomic<Ptr> &src) { return src.load(); }
+            void hold(int, Node*) {}
+            void retire(Node *node) { _domain.retire(node); }
+        private:
+            GarbageQueues &_domain;
+        };
+
+        GarbageQueues(int = 0) {
+            _queue_locks = new QueueLock[_num_queues];
+        }
+
+        ~GarbageQueues() {
+            for(auto &q : _queues) {
+                while(!q.empty()) {
+                    auto ptr = q.front(); q.pop();
+                    delete ptr;
+                }
+            }
+            delete[] _queue_locks;
+        }
+
+        Guard enter() { return Guard(*this); }
+
+    private:
+        void retire(Node *node) {
+            size_t index = random_gen::random_index(_num_queues);
+            _queue_locks[index].lock();
+            _queues[index].push(node);
+            _queue_locks[index].unlock();
+        }
+
+        size_t _num_queues = 12;
+        std::vector<std::queue<Node*>> _queues{_num_queues};
+        QueueLock *_queue_locks;
+    };
+
+    //epoch based reclamation, a node retired in epoch e is freed once the global epoch reached e + 2
+    //threads hold a slot for the duration of one operation, each slot owns its retire list
+    template<class Node>
+    class EpochBased {
+    private:
+        static constexpr size_t _inactive = std::numeric_limits<size_t>::max();
+        struct alignas(64) Slot {
+            std::atomic<size_t> epoch{_inactive}; //announced epoch, _inactive if no thread holds the slot
+            std::vector<std::pair<Node*, size_t>> retired; //node + epoch it was retired in
+        };
+
+    public:
+        static constexpr bool needs_validation = false;
+
+        class Guard {
+        public:
+            Guard(EpochBased &domain) : _domain(domain), _slot(domain.acquire()) {}
+            ~Guard() { _domain.release(_slot); }
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+            //everything reachable after entering stays valid until the guard is released
+            template<class Ptr>
+            Ptr protect(int, const std::atomic<Ptr> &src) { return src.load(); }
+            void hold(int, Node*) {}
+            //node must already be unreachable for threads entering after this call
+            void retire(Node *node) { _domain.retire(_slot, node); }
+        private:
+            EpochBased &_domain;
+            Slot &_slot;
+        };
+
+        EpochBased(int = 0, size_t threshold = 128) : _threshold(threshold) {
+            _num_slots = std::max<size_t>(64, 2 * std::thread::hardware_concurrency());
+            _slots = new Slot[_num_slots];
+        }
+
+        ~EpochBased() {
+            for(size_t i = 0; i < _num_slots; ++i) {
+                for(auto &[node, epoch] : _slots[i].retired) {
+                    delete node;
+                }
+            }
+            delete[] _slots;
+        }
+
+        Guard enter() { return Guard(*this); }
+
+    private:
+        Slot& acquire() {
+            size_t &hint = slot_hint();
+            size_t i = hint % _num_slots;
+            while(true) {
+                size_t expect = _inactive;
+                if(_slots[i].epoch.load(std::memory_order_relaxed) == _inactive &&
+                   _slots[i].epoch.compare_exchange_strong(expect, _epoch.load())) {
+                    hint = i;
+                    return _slots[i];
+                }
+                i = (i + 1) % _num_slots;
+            }
+        }
+
+        void release(Slot &slot) {
+            slot.epoch.store(_inactive, std::memory_order_release);
+        }
+
+        void retire(Slot &slot, Node *node) {
+            slot.retired.push_back({node, _epoch.load()});
+            if(slot.retired.size() >= _threshold) {
+                collect(slot);
+            }
+        }
+
+        //amortized freeing, only touches the retire list of the own slot
+        void collect(Slot &slot) {
+            try_advance();
+            size_t cur_epoch = _epoch.load();
+            auto it = std::partition(slot.retired.begin(), slot.retired.end(), [&](auto &entry) {
+                return entry.second + 2 > cur_epoch;
+            });
+            for(auto del = it; del != slot.retired.end(); ++del) {
+                delete del -> first;
+            }
+            slot.retired.erase(it, slot.retired.end());
+        }
+
+        //epoch can only advance if every active thread announced the current epoch
+        void try_advance() {
+            size_t cur_epoch = _epoch.load();
+            for(size_t i = 0; i < _num_slots; ++i) {
+                size_t e = _slots[i].epoch.load();
+                if(e != _inactive && e != cur_epoch) {
+                    return;
+                }
+            }
+            _epoch.compare_exchange_strong(cur_epoch, cur_epoch + 1);
+        }
+
+        const size_t _threshold;
+        size_t _num_slots;
+        Slot *_slots;
+        alignas(64) std::atomic<size_t> _epoch{0};
+    };
+
+    //hazard pointers, bounded garbage: a node is freed once no active slot publishes it
+    //hazard indices: 0..2 for traversal, 3 + 2 * level for preds, 4 + 2 * level for succs
+    //copies with hold always go to a higher index than the protecting one, scans read indices in increasing order
+    template<class Node>
+    class HazardPointers {
+    private:
+        struct alignas(64) Slot {
+            std::atomic<bool> in_use{false};
+            std::atomic<Node*> *hazards;
+            std::vector<Node*> retired;
+        };
+
+    public:
+        static constexpr bool needs_validation = true;
+
+        class Guard {
+        public:
+            Guard(HazardPointers &domain) : _domain(domain), _slot(domain.acquire()) {}
+            ~Guard() { _domain.release(_slot); }
+            Guard(const Guard&) = delete;
+            Guard& operator=(const Guard&) = delete;
+
+            //publishes the pointer and rereads src until it is stable, caller validates that the source node is still linked
+            template<class Ptr>
+            Ptr protect(int index, const std::atomic<Ptr> &src) {
+                Ptr ptr = src.load();
+                while(true) {
+                    _slot.hazards[index].store(raw_pointer<Node>(ptr));
+                    Ptr again = src.load();
+                    if(again == ptr) {
+                        return ptr;
+                    }
+                    ptr = again;
+                }
+            }
+            //node must already be protected by a lower index
+            void hold(int index, Node *node) { _slot.hazards[index].store(node); }
+            void retire(Node *node) { _domain.retire(_slot, node); }
+        private:
+            HazardPointers &_domain;
+            Slot &_slot;
+        };
+
+        HazardPointers(int max_level = 32) : _num_hazards(2 * max_level + 3) {
+            _num_slots = std::max<size_t>(64, 2 * std::thread::hardware_concurrency());
+            _threshold = std::max<size_t>(64, _num_slots * _num_hazards / 4);
+            _slots = new Slot[_num_slots];
+            for(size_t i = 0; i < _num_slots; ++i) {
+                _slots[i].hazards = new std::atomic<Node*>[_num_hazards];
+                for(size_t j = 0; j < _num_hazards; ++j) {
+                    _slots[i].hazards[j] = nullptr;
+                }
+            }
+        }
+
+        ~HazardPointers() {
+            for(size_t i = 0; i < _num_slots; ++i) {
+                for(auto node : _slots[i].retired) {
+                    delete node;
+                }
+                delete[] _slots[i].hazards;
+            }
+            delete[] _slots;
+        }
+
+        Guard enter() { return Guard(*this); }
+
+    private:
+        Slot& acquire() {
+            size_t &hint = slot_hint();
+            size_t i = hint % _num_slots;
+            while(true) {
+                bool expect = false;
+                if(!_slots[i].in_use.load(std::memory_order_relaxed) && _slots[i].in_use.compare_exchange_strong(expect, true)) {
+                    hint = i;
+                    return _slots[i];
+                }
+                i = (i + 1) % _num_slots;
+            }
+        }
+
+        //stale hazards of a released slot are ignored, a new owner validates before using its pointers
+        void release(Slot &slot) {
+            slot.in_use.store(false, std::memory_order_release);
+        }
+
+        void retire(Slot &slot, Node *node) {
+            slot.retired.push_back(node);
+            if(slot.retired.size() >= _threshold) {
+                scan(slot);
+            }
+        }
+
+        void scan(Slot &slot) {
+            std::vector<Node*> hazards;
+            for(size_t i = 0; i < _num_slots; ++i) {
+                if(!_slots[i].in_use.load()) continue;
+                for(size_t j = 0; j < _num_hazards; ++j) {
+                    Node *ptr = _slots[i].hazards[j].load();
+                    if(ptr != nullptr) hazards.push_back(ptr);
+                }
+            }
+            std::sort(hazards.begin(), hazards.end());
+            auto it = std::partition(slot.retired.begin(), slot.retired.end(), [&](Node *node) {
+                return std::binary_search(hazards.begin(), hazards.end(), node);
+            });
+            for(auto del = it; del != slot.retired.end(); ++del) {
+                delete *del;
+            }
+            slot.retired.erase(it, slot.retired.end());
+        }
+
+        const size_t _num_hazards;
+        size_t _num_slots;
+        size_t _threshold;
+        Slot *_slots;
+    };
+}
@@ -1,36 +1,65 @@
 #pragma once
 
 #include <vector>
+#include <array>
 #include <limits>
 #include <iostream>
+#include <algorithm>
+#include <new>
 
+#include "implementation/node_pool.hpp"
+#include "implementation/bulk_load.hpp"
 #include "random_generator.hpp"
 
-template <class Key, class Value>
+//MaxLevel bounds the max_level given at runtime
+template <class Key, class Value, int MaxLevel = 64>
 class SeqSkipList
 {
 private:
+    struct Node;
     using Level = int;
+    using NodeArray = std::array<Node*, MaxLevel>; //update nodes live on the stack
+    //tower is stored inline behind the node, blocks come from the node pool
     struct Node {
-        Node(Key k, Value val, Level lev) : key(k), value(val), next(lev) {};
-        Key key;
+        Node(Key k, Value val, Level lev) : level(lev), value(val), key(k) {
+            std::fill(next, next + level, nullptr);
+        };
+        static void* operator new(size_t size, Level lev) {
+            return pool::NodePool<Node>::allocate(size + lev * sizeof(Node*), lev);
+        }
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level;
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+        Level get_level() { return level;}
+
+        Level level;
         Value value;
-        std::vector<Node*> next; 
-        Level get_level() { return next.size();}
+        Key key;
+        Node* next[]; 
     };
 public:
-    SeqSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(max_level) {
-        _head = new Node(_min_key, Value(), _max_level);
-        _tail = new Node(_max_key, Value(), _max_level);
+    SeqSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level) {
+        _head = new (_max_level) Node(_min_key, Value(), _max_level);
+        _tail = new (_max_level) Node(_max_key, Value(), _max_level);
         for(int i = 0; i < _max_level; ++i) {
             _head -> next[i] = _tail;
         }
     };
 
+    //bulk load from a random access range of (key, value) pairs sorted by unique keys, O(n) and parallel with OpenMP
+    template<class Iterator>
+    SeqSkipList(const double &probability, const Level &max_level, Iterator first, Iterator last) : SeqSkipList(probability, max_level) {
+        bulk_load(first, last);
+    }
+
     //checks if element with search_key exist, if so it returs the value of the searched element
     std::pair<bool, Value> search(Key &search_key) {
         Node *cur = _head;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] -> key < search_key) {
                 cur = cur -> next[i];
             }
@@ -46,8 +75,12 @@ public:
             x -> value = value;
         }
         else {
-            Level random_level = random_gen::random_level(_p, _max_level);
-            Node *new_node = new Node(insert_key, value, random_level);
+            Level random_level = _level_gen();
+            Node *new_node = new (random_level) Node(insert_key, value, random_level);
+            //levels above the old top start at head
+            for(; _top_level < random_level; ++_top_level) {
+                update[_top_level] = _head;
+            }
             for(int i = 0; i < random_level; ++i) {
                 new_node -> next[i] = update[i] -> next[i];
                 update[i] -> next[i] = new_node;
@@ -62,6 +95,9 @@ public:
             for(int i = 0; i < to_remove -> get_level(); ++i) {
                 update[i] -> next[i] = to_remove -> next[i];
             }
+            while(_top_level > 1 && _head -> next[_top_level - 1] == _tail) {
+                _top_level--;
+            }
             delete to_remove;
             return true;
         }
@@ -86,6 +122,55 @@ public:
         return v;
     }
 
+    //forward cursor over level 0, invalidated by a remove of its element
+    class Cursor {
+    public:
+        bool valid() const { return _cur != _tail; }
+        Key key() const { return _cur -> key; }
+        Value value() const { return _cur -> value; }
+        Cursor& operator++() {
+            _cur = _cur -> next[0];
+            return *this;
+        }
+
+    private:
+        friend class SeqSkipList;
+        Cursor(Node *cur, Node *tail) : _cur(cur), _tail(tail) {}
+
+        Node *_cur;
+        Node *_tail;
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        Node *cur = _head;
+        for(int i = _top_level - 1; i >= 0; --i) {
+            while(cur -> next[i] -> key < search_key) {
+                cur = cur -> next[i];
+            }
+        }
+        return Cursor(cur -> next[0], _tail);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        Node *cur = _head;
+        for(int i = _top_level - 1; i >= 0; --i) {
+            while(cur -> next[i] != _tail && cur -> next[i] -> key <= search_key) {
+                cur = cur -> next[i];
+            }
+        }
+        return Cursor(cur -> next[0], _tail);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order without copying them
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
     bool is_consistent() {
         Node *cur = _head;
         bool ok = true;
@@ -97,11 +182,33 @@ public:
     }
 
 private:
-    //returns a vector of the rightmost node visited on each level
-    std::vector<Node*> get_update_nodes(Key &search_key) {
-        std::vector<Node*> update(_max_level);
+    //towers follow bulk::Layout, nodes are created and linked in two independent parallel loops
+    template<class Iterator>
+    void bulk_load(Iterator first, Iterator last) {
+        const size_t n = last - first;
+        bulk::Layout layout(_p, _max_level, n);
+        std::vector<Node*> nodes(n + 2);
+        nodes[0] = _head;
+        nodes[n + 1] = _tail;
+        #pragma omp parallel for
+        for(size_t i = 1; i <= n; ++i) {
+            Level level = layout.level(i);
+            nodes[i] = new (level) Node(first[i - 1].first, first[i - 1].second, level);
+        }
+        #pragma omp parallel for
+        for(size_t i = 0; i <= n; ++i) {
+            for(Level l = 0; l < nodes[i] -> level; ++l) {
+                nodes[i] -> next[l] = nodes[layout.next(i, l)];
+            }
+        }
+        _top_level = layout.top();
+    }
+
+    //returns the rightmost node visited on each level, levels from the current top upwards are not set
+    NodeArray get_update_nodes(Key &search_key) {
+        NodeArray update;
         Node *cur = _head;
-        for(int i = _max_level - 1; i >= 0; --i) {
+        for(int i = _top_level - 1; i >= 0; --i) {
             while(cur -> next[i] -> key < search_key) {
                 cur = cur -> next[i];
             }
@@ -112,8 +219,10 @@ private:
 
     const double _p;
     const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
     Node *_head;
     Node *_tail;
+    Level _top_level = 1; //levels from here upwards only link head to tail
 
     const Key _min_key = std::numeric_limits<Key>::min();
     const Key _max_key = std::numeric_limits<Key>::max();
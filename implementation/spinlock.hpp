@@ -2,8 +2,23 @@
 
 #include <atomic>
 #include <thread>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 namespace lock {
+  //hint to the core that this is a spin loop, frees pipeline resources for the sibling hyperthread
+  inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield" ::: "memory");
+#else
+    std::this_thread::yield();
+#endif
+  }
+
   class Spinlock {
     std::atomic_flag flag;
 
@@ -18,4 +33,165 @@ namespace lock {
       flag.clear(std::memory_order_release);
     }
   };
-}
\ No newline at end of file
+
+  //shared holders are counted in one word, its top bit closes the gate for the single exclusive holder
+  //lock() waits until the holders that came before have left, later ones wait until unlock()
+  class SharedGate {
+    static constexpr unsigned _closed = 1u << 31;
+    std::atomic<unsigned> word{0};
+
+  public:
+    SharedGate() = default;
+
+    void lock_shared() {
+      while (word.fetch_add(1, std::memory_order_acquire) & _closed) {
+        word.fetch_sub(1, std::memory_order_relaxed);
+        while (word.load(std::memory_order_relaxed) & _closed) cpu_relax();
+      }
+    }
+
+    void unlock_shared() {
+      word.fetch_sub(1, std::memory_order_release);
+    }
+
+    void lock() {
+      while (word.fetch_or(_closed, std::memory_order_acquire) & _closed) {
+        while (word.load(std::memory_order_relaxed) & _closed) cpu_relax();
+      }
+      while (word.load(std::memory_order_acquire) != _closed) cpu_relax();
+    }
+
+    void unlock() {
+      word.fetch_and(~_closed, std::memory_order_release);
+    }
+  };
+
+  //test and test and set, waiters spin on a shared read and only write when the lock looks free
+  //after a failed exchange the pause count doubles up to MaxBackoff, so contenders spread out on the cache line
+  //Park: after SpinBudget pauses waiters sleep in atomic::wait, unlock wakes one of them
+  template<bool Park = false, int MaxBackoff = 64, int SpinBudget = 4096>
+  class BackoffSpinlock {
+    std::atomic<bool> locked{false};
+
+  public:
+    BackoffSpinlock() = default;
+
+    bool try_lock() {
+      return !locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire);
+    }
+
+    void lock() {
+      int backoff = 1;
+      int spun = 0;
+      while (!try_lock()) {
+        for (int i = 0; i < backoff; ++i) cpu_relax();
+        spun += backoff;
+        if (backoff < MaxBackoff) backoff <<= 1;
+        while (locked.load(std::memory_order_relaxed)) {
+          if constexpr (Park) {
+            if (spun >= SpinBudget) {
+              locked.wait(true, std::memory_order_relaxed);
+              continue;
+            }
+          }
+          cpu_relax();
+          spun++;
+        }
+      }
+    }
+
+    void unlock() {
+      locked.store(false, std::memory_order_release);
+      if constexpr (Park) locked.notify_one();
+    }
+  };
+
+  //MCS queue lock, waiters enqueue behind the tail and spin on their own queue node, the lock is handed over in FIFO order
+  //keeps the plain lock()/unlock() interface: queue nodes come from a per thread free list and the holder's node
+  //is stored in the lock, so a thread can hold many node locks at once and release them in any order
+  class MCSLock {
+    struct alignas(64) QNode {
+      std::atomic<QNode*> next{nullptr};
+      std::atomic<bool> waiting{false};
+    };
+
+    struct QNodeCache {
+      std::vector<QNode*> free;
+      ~QNodeCache() {
+        for (QNode *q : free) delete q;
+      }
+    };
+
+    static QNodeCache& cache() {
+      static thread_local QNodeCache c;
+      return c;
+    }
+
+    //a queue node is free again after unlock, no other thread touches it once the lock is handed over
+    static QNode* get_qnode() {
+      auto &c = cache();
+      if (c.free.empty()) return new QNode();
+      QNode *q = c.free.back();
+      c.free.pop_back();
+      return q;
+    }
+
+    static void put_qnode(QNode *q) {
+      cache().free.push_back(q);
+    }
+
+    //FIFO hand over stalls on a descheduled waiter, so long waits give up the core now and then
+    static void spin_wait(int &spins) {
+      if (++spins % 1024 == 0) std::this_thread::yield();
+      else cpu_relax();
+    }
+
+    std::atomic<QNode*> tail{nullptr};
+    QNode *holder = nullptr; //only read and written by the thread holding the lock
+
+  public:
+    MCSLock() = default;
+
+    bool try_lock() {
+      QNode *me = get_qnode();
+      me->next.store(nullptr, std::memory_order_relaxed);
+      QNode *expect = nullptr;
+      if (!tail.compare_exchange_strong(expect, me, std::memory_order_acq_rel)) {
+        put_qnode(me);
+        return false;
+      }
+      holder = me;
+      return true;
+    }
+
+    void lock() {
+      QNode *me = get_qnode();
+      me->next.store(nullptr, std::memory_order_relaxed);
+      me->waiting.store(true, std::memory_order_relaxed);
+      QNode *pred = tail.exchange(me, std::memory_order_acq_rel);
+      if (pred != nullptr) {
+        pred->next.store(me, std::memory_order_release);
+        int spins = 0;
+        while (me->waiting.load(std::memory_order_acquire)) spin_wait(spins);
+      }
+      holder = me;
+    }
+
+    void unlock() {
+      QNode *me = holder;
+      QNode *succ = me->next.load(std::memory_order_acquire);
+      if (succ == nullptr) {
+        QNode *expect = me;
+        if (tail.compare_exchange_strong(expect, nullptr, std::memory_order_acq_rel)) {
+          put_qnode(me);
+          return;
+        }
+        //a waiter swapped the tail but did not link itself yet
+        int spins = 0;
+        while ((succ = me->next.load(std::memory_order_acquire)) == nullptr) spin_wait(spins);
+      }
+      succ->waiting.store(false, std::memory_order_release);
+      put_qnode(me);
+    }
+  };
+}
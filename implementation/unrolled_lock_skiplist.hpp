@@ -0,0 +1,491 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <atomic>
+#include <type_traits>
+#include <new>
+
+#include <immintrin.h>
+
+#include "implementation/spinlock.hpp"
+#include "implementation/reclamation.hpp"
+#include "implementation/node_pool.hpp"
+#include "random_generator.hpp"
+
+//unrolled variant of LockSkipList, every node holds a sorted block of up to BlockSize keys
+//a node covers the keys from its low key up to the low key of its successor, towers are indexed by low keys
+//writers lock the covering node, a full block splits into a new node behind it, an underfull block merges into its predecessor
+//readers search a block optimistically and validate it with the node version, a seqlock, int keys are compared with SIMD
+//blocks are read without locks, so reclamation must not need validation
+//NodeLock guards a block and the node's next pointers, see LockSkipList
+template <class Key, class Value, int BlockSize = 16, template<class> class Reclaimer = reclamation::GarbageQueues, int MaxLevel = 64, class NodeLock = lock::Spinlock>
+class UnrolledLockSkipList
+{
+private:
+    struct Node;
+    using Level = int;
+    using Lock = NodeLock;
+    using Reclaim = Reclaimer<Node>;
+    using Guard = typename Reclaim::Guard;
+    using NodeArray = std::array<Node*, MaxLevel>; //preds and succs live on the stack
+
+    static_assert(!Reclaim::needs_validation, "blocks are read optimistically, nodes have to stay valid for the whole operation");
+    static_assert(BlockSize >= 4 && BlockSize % 4 == 0, "blocks are compared four keys at a time");
+
+    //keys first, one cache line for 16 int keys, unused slots hold the max key so a block is always sorted
+    //tower is stored inline behind the node like in LockSkipList
+    struct alignas(64) Node {
+        Node(Key l, Level lev) : level(lev), lock(), beeing_deleted(false), low(l) {
+            std::fill(keys, keys + BlockSize, std::numeric_limits<Key>::max());
+            for(Level i = 0; i < level; ++i) {
+                new (&next[i]) std::atomic<Node*>(nullptr);
+            }
+        };
+        //the block ends with the tower, the padding of the aligned struct is not allocated
+        static void* operator new(size_t, Level lev) {
+            return pool::NodePool<Node>::allocate(offsetof(Node, next) + lev * sizeof(std::atomic<Node*>), lev);
+        }
+        //destroying delete, the size class is taken from the level
+        static void operator delete(Node *ptr, std::destroying_delete_t) {
+            Level lev = ptr -> level;
+            ptr -> ~Node();
+            pool::NodePool<Node>::deallocate(ptr, lev);
+        }
+        static void operator delete(void *ptr, Level lev) { pool::NodePool<Node>::deallocate(ptr, lev); }
+
+        //number of keys below k, the position of k in the block
+        int rank(Key k) const {
+            if constexpr(std::is_same_v<Key, int>) {
+#if defined(__AVX2__)
+                if constexpr(BlockSize % 8 == 0) {
+                    const __m256i needle = _mm256_set1_epi32(k);
+                    int r = 0;
+                    for(int i = 0; i < BlockSize; i += 8) {
+                        __m256i block = _mm256_load_si256(reinterpret_cast<const __m256i*>(keys + i));
+                        r += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(needle, block))));
+                    }
+                    return r;
+                }
+#endif
+#if defined(__SSE4_2__)
+                const __m128i needle = _mm_set1_epi32(k);
+                int r = 0;
+                for(int i = 0; i < BlockSize; i += 4) {
+                    __m128i block = _mm_load_si128(reinterpret_cast<const __m128i*>(keys + i));
+                    r += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(needle, block))));
+                }
+                return r;
+#endif
+            }
+            return std::lower_bound(keys, keys + BlockSize, k) - keys;
+        }
+
+        //writers bump the version to odd before and back to even after changing the block or next[0]
+        void begin_write() {
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        void end_write() {
+            version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        alignas(64) Key keys[BlockSize];
+        Value values[BlockSize];
+        int count = 0;
+        std::atomic<unsigned> version{0};
+        Level level;
+        Lock lock;
+        std::atomic<bool> beeing_deleted; //merged into its predecessor, only upper levels might still link it
+        const Key low; //lower bound of the covered keys, fixed for the lifetime of the node
+        std::atomic<Node*> next[];
+    };
+public:
+    UnrolledLockSkipList(const double &probability, const Level &max_level = 20) : _p(probability), _max_level(std::min(max_level, MaxLevel)), _level_gen(probability, _max_level), _reclaimer(_max_level) {
+        _head = new (_max_level) Node(_min_key, _max_level); //covers the keys below the first low key
+        _tail = new (_max_level) Node(_max_key, _max_level);
+        for(int i = 0; i < _max_level; ++i) {
+            _head -> next[i] = _tail;
+        }
+        for(int i = 0; i < _max_level; ++i) {
+            _tail -> next[i] = _tail; //safety
+        }
+    };
+
+    std::pair<bool, Value> search(Key search_key) {
+        [[maybe_unused]] auto guard = _reclaimer.enter();
+        while(true) {
+            Node *x = find(search_key);
+            while(true) {
+                unsigned version = x -> version.load(std::memory_order_acquire);
+                if(version & 1) {
+                    lock::cpu_relax();
+                    continue;
+                }
+                if(x -> beeing_deleted) break;
+                Node *succ = x -> next[0];
+                if(succ -> low <= search_key) { //a split moved the key to the right
+                    x = succ;
+                    continue;
+                }
+                int pos = x -> rank(search_key);
+                bool found = pos < x -> count && x -> keys[pos] == search_key;
+                Value value = found ? x -> values[pos] : Value();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(x -> version.load(std::memory_order_relaxed) == version) {
+                    return {found, value};
+                }
+            }
+        }
+    }
+
+    void insert(Key insert_key, Value value) {
+        [[maybe_unused]] auto guard = _reclaimer.enter();
+        while(true) {
+            Node *x = find(insert_key);
+            x -> lock.lock();
+            if(!covers(x, insert_key)) {
+                x -> lock.unlock();
+                continue;
+            }
+            int pos = x -> rank(insert_key);
+            if(pos < x -> count && x -> keys[pos] == insert_key) {
+                x -> begin_write();
+                x -> values[pos] = value;
+                x -> end_write();
+                x -> lock.unlock();
+                return;
+            }
+            if(x -> count < BlockSize) {
+                x -> begin_write();
+                insert_at(x, pos, insert_key, value);
+                x -> end_write();
+                x -> lock.unlock();
+                return;
+            }
+            split(x, pos, insert_key, value);
+            return;
+        }
+    }
+
+    bool remove(Key remove_key) {
+        auto guard = _reclaimer.enter();
+        while(true) {
+            Node *x = find(remove_key);
+            x -> lock.lock();
+            if(!covers(x, remove_key)) {
+                x -> lock.unlock();
+                continue;
+            }
+            int pos = x -> rank(remove_key);
+            if(pos >= x -> count || x -> keys[pos] != remove_key) {
+                x -> lock.unlock();
+                return false;
+            }
+            x -> begin_write();
+            std::copy(x -> keys + pos + 1, x -> keys + x -> count, x -> keys + pos);
+            std::copy(x -> values + pos + 1, x -> values + x -> count, x -> values + pos);
+            x -> count--;
+            x -> keys[x -> count] = _max_key;
+            x -> end_write();
+            if(x != _head && x -> count <= BlockSize / 4) {
+                merge(guard, x); //unlocks x
+            }
+            else {
+                x -> lock.unlock();
+            }
+            return true;
+        }
+    }
+
+    bool is_consistent() {
+        bool ok = true;
+        for(Node *cur = _head; cur != _tail; cur = cur -> next[0]) {
+            Node *succ = cur -> next[0];
+            ok &= cur -> low < succ -> low && cur -> count <= BlockSize && (cur == _head || cur -> count > 0);
+            for(int i = 0; i < cur -> count; ++i) {
+                ok &= cur -> low <= cur -> keys[i] && cur -> keys[i] < succ -> low;
+                ok &= i == 0 || cur -> keys[i - 1] < cur -> keys[i];
+            }
+            for(int i = cur -> count; i < BlockSize; ++i) {
+                ok &= cur -> keys[i] == _max_key;
+            }
+        }
+        for(Level l = 1; l < _max_level; ++l) {
+            for(Node *cur = _head; cur != _tail; cur = cur -> next[l]) {
+                ok &= cur -> low < cur -> next[l].load() -> low && !(cur -> beeing_deleted);
+            }
+        }
+        return ok;
+    }
+
+    void print() {
+        for(Node *cur = _head; cur != _tail; cur = cur -> next[0]) {
+            std::cout << "[";
+            for(int i = 0; i < cur -> count; ++i) {
+                std::cout << cur -> keys[i] << (i + 1 < cur -> count ? " " : "");
+            }
+            std::cout << "] ";
+        }
+        std::cout << "\n";
+    }
+
+    std::vector<Key> get_keys() {
+        std::vector<Key> v;
+        for(Node *cur = _head; cur != _tail; cur = cur -> next[0]) {
+            v.insert(v.end(), cur -> keys, cur -> keys + cur -> count);
+        }
+        return v;
+    }
+
+    //weakly consistent forward cursor, copies the rest of one block under its version and continues at the low key of the successor
+    //keys that stay in the list are seen once and in order, a split or merge only moves keys between neighboring blocks
+    //holds a guard of the reclamation policy for its whole lifetime, keep it short lived
+    class Cursor {
+    public:
+        bool valid() const { return _pos < _count; }
+        Key key() const { return _keys[_pos]; }
+        Value value() const { return _values[_pos]; }
+        Cursor& operator++() {
+            if(++_pos == _count && !_last) {
+                load(_next_low, false);
+            }
+            return *this;
+        }
+
+    private:
+        friend class UnrolledLockSkipList;
+        Cursor(UnrolledLockSkipList &list, Key bound, bool strict) : _list(list), _guard(list._reclaimer.enter()) {
+            load(bound, strict);
+        }
+
+        //copies the keys >= bound, > bound if strict, from the block covering bound, empty rests move on to the next block
+        void load(Key bound, bool strict) {
+            Node *x = _list.find(bound);
+            while(true) {
+                unsigned version = x -> version.load(std::memory_order_acquire);
+                if(version & 1) {
+                    lock::cpu_relax();
+                    continue;
+                }
+                if(x -> beeing_deleted) {
+                    x = _list.find(bound);
+                    continue;
+                }
+                Node *succ = x -> next[0];
+                if(succ -> low <= bound) { //a split moved the bound to the right
+                    x = succ;
+                    continue;
+                }
+                int count = std::min(x -> count, BlockSize); //torn reads are discarded below, but must stay in the block
+                int pos = std::min(x -> rank(bound), count);
+                if(strict && pos < count && x -> keys[pos] == bound) pos++;
+                std::copy(x -> keys + pos, x -> keys + count, _keys);
+                std::copy(x -> values + pos, x -> values + count, _values);
+                Key next_low = succ -> low;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(x -> version.load(std::memory_order_relaxed) != version) {
+                    continue;
+                }
+                _pos = 0;
+                _count = count - pos;
+                _last = succ == _list._tail;
+                _next_low = next_low;
+                if(_count > 0 || _last) {
+                    return;
+                }
+                x = succ;
+                bound = next_low;
+                strict = false;
+            }
+        }
+
+        UnrolledLockSkipList &_list;
+        Guard _guard;
+        Key _keys[BlockSize];
+        Value _values[BlockSize];
+        int _pos = 0, _count = 0;
+        bool _last = true; //the copied block is the last one
+        Key _next_low; //low key of the successor of the copied block
+    };
+
+    //first element with key >= search_key
+    Cursor lower_bound(Key search_key) {
+        return Cursor(*this, search_key, false);
+    }
+
+    //first element with key > search_key
+    Cursor upper_bound(Key search_key) {
+        return Cursor(*this, search_key, true);
+    }
+
+    //calls callback(key, value) for all keys in [from, to) in ascending order
+    template<class Callback>
+    void scan(Key from, Key to, Callback callback) {
+        for(auto cur = lower_bound(from); cur.valid() && cur.key() < to; ++cur) {
+            callback(cur.key(), cur.value());
+        }
+    }
+
+private:
+    //levels above the highest tower only link head to tail, the top never decreases while threads run
+    void raise_top_level(Level level) {
+        Level top = _top_level.load(std::memory_order_relaxed);
+        while(top < level && !_top_level.compare_exchange_weak(top, level)) {}
+    }
+
+    //x is locked and still responsible for key
+    bool covers(Node *x, Key key) {
+        return !(x -> beeing_deleted) && key < x -> next[0].load() -> low;
+    }
+
+    static void insert_at(Node *x, int pos, Key key, Value value) {
+        std::copy_backward(x -> keys + pos, x -> keys + x -> count, x -> keys + x -> count + 1);
+        std::copy_backward(x -> values + pos, x -> values + x -> count, x -> values + x -> count + 1);
+        x -> keys[pos] = key;
+        x -> values[pos] = value;
+        x -> count++;
+    }
+
+    //x is locked and full, the upper half moves to a new node behind x, then the new node gets its tower
+    void split(Node *x, int pos, Key key, Value value) {
+        constexpr int half = BlockSize / 2;
+        Level random_level = _level_gen();
+        raise_top_level(random_level);
+        //key stays in x if it lies below the first moved key, so that key is the new low key either way
+        Node *new_node = new (random_level) Node(x -> keys[half], random_level);
+        std::copy(x -> keys + half, x -> keys + BlockSize, new_node -> keys);
+        std::copy(x -> values + half, x -> values + BlockSize, new_node -> values);
+        new_node -> count = BlockSize - half;
+        if(pos > half) {
+            insert_at(new_node, pos - half, key, value);
+        }
+        new_node -> next[0] = x -> next[0].load();
+        new_node -> lock.lock(); //no merge until the tower is linked
+        x -> begin_write();
+        std::fill(x -> keys + half, x -> keys + BlockSize, _max_key);
+        x -> count = half;
+        if(pos <= half) {
+            insert_at(x, pos, key, value);
+        }
+        x -> next[0] = new_node;
+        x -> end_write();
+        x -> lock.unlock();
+
+        NodeArray preds, succs;
+        get_update_nodes(preds, succs, new_node -> low);
+        auto validate = [&](int j) {
+            return !(preds[j] -> beeing_deleted) && !(succs[j] -> beeing_deleted) && preds[j] -> next[j] == succs[j];
+        };
+        for(Level i = 1; i < random_level; ++i) {
+            while(true) {
+                if(validate(i)) {
+                    preds[i] -> lock.lock();
+                    if(validate(i)) {
+                        new_node -> next[i] = succs[i];
+                        preds[i] -> next[i] = new_node;
+                        preds[i] -> lock.unlock();
+                        break;
+                    }
+                    preds[i] -> lock.unlock();
+                }
+                get_update_nodes(preds, succs, new_node -> low);
+            }
+        }
+        new_node -> lock.unlock();
+    }
+
+    //x is locked and underfull, its keys move into its predecessor on level 0 if they fit, then x is unlinked top-down
+    void merge(Guard &guard, Node *x) {
+        NodeArray preds, succs;
+        Node *pred;
+        while(true) {
+            get_update_nodes(preds, succs, x -> low);
+            pred = preds[0];
+            pred -> lock.lock();
+            if(!(pred -> beeing_deleted) && pred -> next[0] == x) {
+                break;
+            }
+            pred -> lock.unlock();
+        }
+        if(pred -> count + x -> count > BlockSize) {
+            pred -> lock.unlock();
+            x -> lock.unlock();
+            return;
+        }
+        x -> beeing_deleted = true;
+        pred -> begin_write();
+        x -> begin_write();
+        std::copy(x -> keys, x -> keys + x -> count, pred -> keys + pred -> count);
+        std::copy(x -> values, x -> values + x -> count, pred -> values + pred -> count);
+        pred -> count += x -> count;
+        pred -> next[0] = x -> next[0].load();
+        x -> end_write();
+        pred -> end_write();
+        pred -> lock.unlock();
+
+        auto validate = [&](int j) {
+            return !(preds[j] -> beeing_deleted) && preds[j] -> next[j] == x;
+        };
+        for(Level i = x -> level - 1; i >= 1; --i) {
+            while(true) {
+                if(validate(i)) {
+                    preds[i] -> lock.lock();
+                    if(validate(i)) {
+                        preds[i] -> next[i] = x -> next[i].load();
+                        preds[i] -> lock.unlock();
+                        break;
+                    }
+                    preds[i] -> lock.unlock();
+                }
+                get_update_nodes(preds, succs, x -> low);
+            }
+        }
+        x -> lock.unlock();
+        guard.retire(x);
+    }
+
+    //descent by low keys, returns the level 0 node covering search_key
+    Node* find(Key search_key) {
+        Node *pred = _head;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            Node *succ = pred -> next[i];
+            while(succ -> low <= search_key) {
+                pred = succ;
+                succ = pred -> next[i];
+            }
+        }
+        return pred;
+    }
+
+    //last nodes with a low key below search_key and their successors
+    //only levels below the current top are filled, every linked or inserting node lies below it
+    void get_update_nodes(NodeArray &preds, NodeArray &succs, Key search_key) {
+        Node *pred = _head;
+        for(int i = _top_level.load() - 1; i >= 0; --i) {
+            Node *succ = pred -> next[i];
+            while(succ -> low < search_key) {
+                pred = succ;
+                succ = pred -> next[i];
+            }
+            preds[i] = pred;
+            succs[i] = succ;
+        }
+    }
+
+    const double _p;
+    const Level _max_level;
+    const random_gen::LevelGenerator _level_gen; //thread local state, shared thresholds
+    Node *_head;
+    Node *_tail;
+    std::atomic<Level> _top_level{1}; //number of levels used by any tower
+
+    Reclaim _reclaimer;
+
+    const Key _min_key = std::numeric_limits<Key>::min();
+    const Key _max_key = std::numeric_limits<Key>::max();
+};
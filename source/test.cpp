@@ -7,8 +7,10 @@
 #include <string>
 #include <thread>
 #include <atomic>
+#include <cmath>
 
 #include <memory>
+#include <mutex>
 
 #include "implementation/random_generator.hpp"
 #include "implementation/seq_skiplist.hpp"
@@ -21,6 +23,8 @@
 
 #include "implementation/lockfree_skiplist.hpp"
 
+#include "implementation/unrolled_lock_skiplist.hpp"
+
 
 #define V(x) std::string(#x "=") << (x) << " "
 
@@ -36,6 +40,29 @@ void test_random_generator(const double p, const int max_level, const int n) {
     std::cout << "\n";
 }
 
+//level frequencies of the single draw generator have to match p^(l-1), same seed gives the same levels
+void test_level_generator(const double p, const int max_level, const int n) {
+    random_gen::LevelGenerator gen(p, max_level);
+    std::vector<int> count(max_level + 1, 0);
+    for(int i = 0; i < n; i++) {
+        count[gen()]++;
+    }
+    bool ok = count[0] == 0;
+    double at_least = n; //draws with level >= l
+    for(int l = 1; l <= 4 && l <= max_level; l++) {
+        double expected = n * std::pow(p, l - 1);
+        ok &= std::abs(at_least - expected) < 0.05 * n;
+        at_least -= count[l];
+    }
+    random_gen::seed(42);
+    std::vector<int> first(100), second(100);
+    for(auto &x : first) x = gen();
+    random_gen::seed(42);
+    for(auto &x : second) x = gen();
+    ok &= first == second;
+    std::cout << "level generator p=" << p << " -> " << ok << "\n";
+}
+
 void test_seq_skiplist_with(const double p, const int max_level, std::vector<int> &v) {
     SeqSkipList<int,int> slist(p, max_level);
     for(auto &x : v) {
@@ -160,6 +187,134 @@ bool test_index_par_skiplist_with(const double p, const int max_level, const int
     return complete.load();
 }
 
+//lengths from the parallel pass, then from the incremental pass after removing and reinserting a part of the keys
+bool test_parallel_indices_with(const double p, const int max_level, const int num_threads, std::vector<int> &v) {
+    IndexableLockSkipList<int,int> slist(p, max_level);
+    auto run = [&](auto work) {
+        std::vector<std::thread> threads;
+        for(int t = 0; t < num_threads; ++t) {
+            threads.emplace_back(work, t);
+        }
+        for(auto &t : threads) {
+            t.join();
+        }
+    };
+    auto check = [&]() {
+        std::vector<int> keys = slist.get_keys();
+        bool ok = true;
+        for(int i = 0; i < (int)keys.size(); ++i) {
+            auto[ok1, val] = slist.element_at(i);
+            auto[ok2, rank] = slist.rank(keys[i]);
+            ok &= ok1 && ok2 && val == keys[i] && rank == i;
+        }
+        return ok;
+    };
+    const int n = v.size();
+    run([&](int t) {
+        for(int i = t; i < n; i += num_threads) slist.insert(v[i], v[i]);
+    });
+    slist.compute_indices_parallel();
+    bool ok = check();
+    run([&](int t) {
+        for(int i = t; i < n / 3; i += num_threads) slist.remove(v[i]);
+    });
+    slist.compute_indices_incremental();
+    ok &= check();
+    run([&](int t) {
+        for(int i = t; i < n / 6; i += num_threads) slist.insert(v[i], v[i]);
+    });
+    slist.compute_indices_incremental();
+    ok &= check();
+    return ok;
+}
+
+void test_parallel_indices(const double p, const int max_level, const int n, const int it, const int num_threads) {
+    std::vector<int> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    bool all_ok = true;
+    for(int i = 0; i < it; ++i) {
+        random_gen::shuffle<int>(v);
+        bool ok = test_parallel_indices_with(p, max_level, num_threads, v);
+        all_ok &= ok;
+        std::cout << "test " << i + 1 << " -> " << ok << "\n";
+    }
+    std::cout << "all test -> " << all_ok << "\n";
+}
+
+//lengths are maintained by the writers: rank of a preloaded even key stays between its bounds while odd keys come and go
+template<class Slist>
+bool test_live_index_par_skiplist_with(const double p, const int max_level, const int num_threads, std::vector<int> &v) {
+    const int n = v.size();
+    Slist slist(p, max_level);
+    std::atomic<bool> complete = true;
+    auto run = [&](auto work) {
+        std::vector<std::thread> threads;
+        for(int t = 0; t < num_threads; ++t) {
+            threads.emplace_back(work, t);
+        }
+        for(auto &t : threads) {
+            t.join();
+        }
+    };
+    auto check_exact = [&](int step) {
+        run([&](int t) {
+            for(int i = t; i < n; i += num_threads) {
+                int x = step * v[i];
+                auto[ok1, val] = slist.element_at(v[i]);
+                auto[ok2, rank] = slist.rank(x);
+                if(!ok1 || !ok2 || val != x || rank != v[i]) {
+                    std::cout << "live index wrong " << x << " " << val << " " << rank << "\n";
+                    complete = false;
+                }
+            }
+        });
+    };
+    //thread 0 checks the bounds while the other threads change all odd keys
+    auto churn_odd = [&](bool insert) {
+        run([&](int t) {
+            if(t == 0) {
+                for(int i = 0; i < n; ++i) {
+                    auto[ok, rank] = slist.rank(2 * v[i]);
+                    if(!ok || rank < v[i] || rank > 2 * v[i]) {
+                        std::cout << "live rank out of bounds " << 2 * v[i] << " " << rank << "\n";
+                        complete = false;
+                    }
+                }
+                return;
+            }
+            for(int i = t - 1; i < n; i += num_threads - 1) {
+                if(insert) slist.insert(2 * v[i] + 1, 2 * v[i] + 1);
+                else slist.remove(2 * v[i] + 1);
+            }
+        });
+    };
+    run([&](int t) {
+        for(int i = t; i < n; i += num_threads) {
+            slist.insert(2 * v[i], 2 * v[i]);
+        }
+    });
+    check_exact(2);
+    churn_odd(true);
+    complete = complete && slist.is_consistent();
+    churn_odd(false);
+    check_exact(2);
+    return complete.load();
+}
+
+template<class Slist>
+void test_live_index_par_skiplist(const double p, const int max_level, const int n, const int it, const int num_threads) {
+    std::vector<int> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    bool all_ok = true;
+    for(int i = 0; i < it; ++i) {
+        random_gen::shuffle<int>(v);
+        bool ok = test_live_index_par_skiplist_with<Slist>(p, max_level, std::max(num_threads, 2), v);
+        all_ok &= ok;
+        std::cout << "test " << i + 1 << " -> " << ok << "\n";
+    }
+    std::cout << "all test -> " << all_ok << "\n";
+}
+
 void test_index_par_skiplist(const double p, const int max_level, const int n, const int it, const int num_threads) {
     std::vector<int> v(n);
     std::iota(v.begin(), v.end(), 0);
@@ -173,6 +328,341 @@ void test_index_par_skiplist(const double p, const int max_level, const int n, c
     std::cout << "all test -> " << all_ok << "\n";
 }
 
+//insert and remove the same keys for several rounds, removed nodes get reclaimed while the list is live
+template<class Slist>
+bool test_churn(const double p, const int max_level, const int n, const int rounds, const int num_threads) {
+    Slist slist(p, max_level);
+    std::vector<std::thread> threads;
+    std::atomic<bool> correct = true;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            for(int r = 0; r < rounds; ++r) {
+                for(int x = t; x < n; x += num_threads) {
+                    slist.insert(x, x);
+                }
+                for(int x = t; x < n; x += num_threads) {
+                    auto[is_in, value] = slist.search(x);
+                    if(!is_in || value != x || !slist.remove(x)) correct = false;
+                }
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    threads.clear();
+    bool ok = correct.load() && slist.get_keys().empty() && slist.is_consistent();
+    std::cout << "churn test -> " << ok << "\n";
+    return ok;
+}
+
+//even keys stay, bounds and scans have to see all of them in order while other threads insert and remove odd keys
+template<class Slist>
+bool test_range_scan(const double p, const int max_level, const int n, const int num_threads) {
+    Slist slist(p, max_level);
+    std::atomic<bool> correct = true;
+    for(int x = 0; x < 2 * n; x += 2) {
+        int value = x;
+        slist.insert(x, value);
+    }
+    for(int x = 0; x < 2 * n - 2; x += 2) {
+        auto lower = slist.lower_bound(x + 1);
+        auto upper = slist.upper_bound(x);
+        if(!lower.valid() || lower.key() != x + 2 || !upper.valid() || upper.key() != x + 2) correct = false;
+    }
+    if(slist.upper_bound(2 * n - 2).valid() || slist.lower_bound(-1).key() != 0) correct = false;
+    auto check_scan = [&](int from, int to) {
+        int expect = from + from % 2;
+        slist.scan(from, to, [&](int key, int value) {
+            if(key % 2 == 1) return; //odd keys come and go
+            if(key != expect || value != key) correct = false;
+            expect += 2;
+        });
+        if(expect < std::min(to, 2 * n)) correct = false;
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            if(t == 0) {
+                for(int from = 0; from < 2 * n; from += n / 8 + 1) {
+                    check_scan(from, from + n / 4);
+                }
+                return;
+            }
+            for(int x = 2 * t - 1; x < 2 * n; x += 2 * (num_threads - 1)) {
+                int value = x;
+                slist.insert(x, value);
+                slist.remove(x);
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    check_scan(0, 2 * n);
+    std::cout << "range scan test -> " << correct.load() << "\n";
+    return correct.load();
+}
+
+//bulk loaded keys 0, 2, ..., then the odd keys are inserted and removed again through the normal paths
+template<class Slist, bool indexable = false>
+bool test_bulk_load(const double p, const int max_level, const int n) {
+    std::vector<std::pair<int,int>> pairs(n);
+    for(int i = 0; i < n; ++i) {
+        pairs[i] = {2 * i, 2 * i};
+    }
+    Slist slist(p, max_level, pairs.begin(), pairs.end());
+    bool ok = true;
+    auto check = [&](int step) {
+        int expect = 0;
+        slist.scan(0, 2 * n, [&](int key, int value) {
+            ok &= key == expect && value == key;
+            expect += step;
+        });
+        ok &= expect == 2 * n;
+        for(int x = 0; x < 2 * n; x += step) {
+            auto[is_in, value] = slist.search(x);
+            ok &= is_in && value == x;
+            if constexpr(indexable) {
+                auto[ok1, val] = slist.element_at(x / step);
+                auto[ok2, rank] = slist.rank(x);
+                ok &= ok1 && ok2 && val == x && rank == x / step;
+            }
+        }
+    };
+    check(2);
+    for(int x = 1; x < 2 * n; x += 2) {
+        int value = x;
+        slist.insert(x, value);
+    }
+    if constexpr(indexable) {
+        if constexpr(requires { slist.compute_indices(); }) slist.compute_indices_incremental();
+    }
+    check(1);
+    for(int x = 1; x < 2 * n; x += 2) {
+        slist.remove(x);
+    }
+    if constexpr(indexable) {
+        if constexpr(requires { slist.compute_indices(); }) slist.compute_indices_incremental();
+    }
+    check(2);
+    std::cout << "bulk load test -> " << ok << "\n";
+    return ok;
+}
+
+//threads insert interleaved sorted batches while another thread removes the odd keys in between
+template<class Slist, bool indexable = false>
+bool test_insert_batch(const double p, const int max_level, const int n, const int num_threads) {
+    Slist slist(p, max_level);
+    const int batch = 64;
+    for(int x = 1; x < 2 * n; x += 2) {
+        int value = x;
+        slist.insert(x, value);
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            if(t == 0) {
+                for(int x = 1; x < 2 * n; x += 2) {
+                    slist.remove(x);
+                }
+                return;
+            }
+            std::vector<std::pair<int,int>> pairs;
+            for(int x = 2 * (t - 1); x < 2 * n; x += 2 * (num_threads - 1)) {
+                pairs.push_back({x, x});
+                if(pairs.size() == batch || x + 2 * (num_threads - 1) >= 2 * n) {
+                    slist.insert_batch(pairs.begin(), pairs.end());
+                    slist.insert_batch(pairs.begin(), pairs.begin() + pairs.size() / 2); //keys that are already in
+                    pairs.clear();
+                }
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    bool ok = true;
+    if constexpr(indexable) slist.compute_indices(); //is_consistent expects consecutive keys
+    else ok = slist.is_consistent();
+    std::vector<int> keys = slist.get_keys();
+    ok &= keys.size() == size_t(n);
+    for(int i = 0; ok && i < n; ++i) {
+        auto[is_in, value] = slist.search(2 * i);
+        ok &= keys[i] == 2 * i && is_in && value == 2 * i;
+        if constexpr(indexable) {
+            auto[found, val] = slist.element_at(i);
+            ok &= found && val == 2 * i;
+        }
+    }
+    std::cout << "insert batch test -> " << ok << "\n";
+    return ok;
+}
+
+//threads append even keys through their finger and read each one back while another thread removes the odd keys
+template<class Slist>
+bool test_finger(const double p, const int max_level, const int n, const int num_threads) {
+    Slist slist(p, max_level);
+    std::atomic<bool> correct = true;
+    for(int x = 1; x < 2 * n; x += 2) {
+        int value = x;
+        slist.insert(x, value);
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            if(t == 0) {
+                for(int x = 1; x < 2 * n; x += 2) {
+                    slist.remove(x);
+                }
+                return;
+            }
+            auto finger = slist.finger();
+            for(int x = 2 * (t - 1); x < 2 * n; x += 2 * (num_threads - 1)) {
+                int value = x;
+                slist.insert(finger, x, value);
+                auto[is_in, val] = slist.search(finger, x);
+                if(!is_in || val != x) correct = false;
+                slist.search(finger, x / 2); //step back, odd keys are in or out
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    auto finger = slist.finger();
+    for(int x = 2 * n - 1; x >= 0; --x) {
+        auto[is_in, value] = slist.search(finger, x);
+        if(is_in != (x % 2 == 0) || (is_in && value != x)) correct = false;
+    }
+    bool ok = correct.load() && slist.is_consistent();
+    std::cout << "finger test -> " << ok << "\n";
+    return ok;
+}
+
+//batched lookups have to find every even key while another thread inserts and removes the odd keys
+template<class Slist>
+bool test_multi_search(const double p, const int max_level, const int n, const int num_threads) {
+    Slist slist(p, max_level);
+    std::atomic<bool> correct = true;
+    for(int x = 0; x < 2 * n; x += 2) {
+        int value = x;
+        slist.insert(x, value);
+    }
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            if(t == 0) {
+                for(int x = 1; x < 2 * n; x += 2) {
+                    int value = x;
+                    slist.insert(x, value);
+                    slist.remove(x);
+                }
+                return;
+            }
+            std::vector<int> keys;
+            std::vector<std::pair<bool, int>> results;
+            for(size_t batch : {1, 7, 64, 300}) {
+                keys.clear();
+                for(size_t i = 0; i < batch; ++i) {
+                    keys.push_back(int(random_gen::random_index(2 * n + 2)) - 1);
+                }
+                slist.multi_search(keys, results);
+                for(size_t i = 0; i < batch; ++i) {
+                    int x = keys[i];
+                    bool even = x >= 0 && x < 2 * n && x % 2 == 0;
+                    if((even && (!results[i].first || results[i].second != x)) || ((x < 0 || x >= 2 * n) && results[i].first)) correct = false;
+                }
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    std::vector<int> keys(2 * n + 2);
+    std::iota(keys.begin(), keys.end(), -1);
+    random_gen::shuffle<int>(keys);
+    std::vector<std::pair<bool, int>> results;
+    slist.multi_search(keys, results);
+    for(size_t i = 0; i < keys.size(); ++i) {
+        bool even = keys[i] >= 0 && keys[i] < 2 * n && keys[i] % 2 == 0;
+        if(results[i].first != even || (even && results[i].second != keys[i])) correct = false;
+    }
+    std::cout << "multi search test -> " << correct.load() << "\n";
+    return correct.load();
+}
+
+//threads insert disjoint keys and pop concurrently, every key has to come out exactly once, alone pops are sorted
+//spray: concurrent pops are relaxed with spray_pop, the final drain stays strict
+template<class Slist, bool batched, bool spray = false>
+bool test_pop_min(const double p, const int max_level, const int n, const int num_threads) {
+    Slist slist(p, max_level);
+    std::vector<int> v(n);
+    std::iota(v.begin(), v.end(), 0);
+    random_gen::shuffle<int>(v);
+    std::vector<std::vector<int>> work_threads(num_threads);
+    for(int i = 0; i < n; ++i) {
+        work_threads[i % num_threads].push_back(v[i]);
+    }
+    std::vector<std::vector<int>> popped(num_threads + 1);
+    auto pop = [&](auto &batch, std::vector<int> &out, bool relaxed) {
+        std::tuple<bool, int, int> item;
+        if constexpr(spray) {
+            if(relaxed) item = slist.spray_pop(batch, num_threads);
+            else item = slist.pop_min(batch);
+        }
+        else if constexpr(batched) item = slist.pop_min(batch);
+        else item = slist.pop_min();
+        auto[ok, key, value] = item;
+        if(ok) out.push_back(key == value ? key : -1);
+        return ok;
+    };
+    std::vector<std::thread> threads;
+    for(int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            auto batch = slist.pop_batch(16);
+            for(size_t i = 0; i < work_threads[t].size(); ++i) {
+                int x = work_threads[t][i];
+                slist.insert(x, x);
+                if(i % 2 == 1) pop(batch, popped[t], true);
+            }
+        });
+    }
+    for(auto &t : threads) {
+        t.join();
+    }
+    bool ok = true;
+    {
+        auto batch = slist.pop_batch(16);
+        int last = -1;
+        while(true) {
+            auto[peek_ok, peek_key, peek_value] = slist.peek_min();
+            if(!pop(batch, popped[num_threads], false)) {
+                ok &= !peek_ok;
+                break;
+            }
+            ok &= peek_ok && peek_key == popped[num_threads].back() && peek_value == peek_key;
+            ok &= popped[num_threads].back() > last; //nobody else pops, so the rest comes out sorted
+            last = popped[num_threads].back();
+        }
+    }
+    std::vector<int> all;
+    for(auto &keys : popped) {
+        all.insert(all.end(), keys.begin(), keys.end());
+    }
+    std::sort(all.begin(), all.end());
+    ok &= all.size() == size_t(n);
+    for(int i = 0; ok && i < n; ++i) {
+        ok &= all[i] == i;
+    }
+    ok &= slist.get_keys().empty() && slist.is_consistent();
+    std::cout << (spray ? "spray pop test -> " : "pop min test -> ") << ok << "\n";
+    return ok;
+}
+
+template<class Node>
+using BackoffGarbageQueues = reclamation::GarbageQueues<Node, lock::BackoffSpinlock<>>;
+
 template<class Slist>
 class ParTest {
  public:
@@ -519,6 +1009,23 @@ int main()
     //indeaxable
     ParTest<IndexableLockSkipList<int,int>> tester3(p, max_level, n, it, num_threads);
 
+    //reclamation policies
+    ParTest<LockSkipList<int,int,false,reclamation::EpochBased>> tester4(p, max_level, n, it, num_threads);
+    ParTest<LockSkipList<int,int,false,reclamation::HazardPointers>> tester5(p, max_level, n, it, num_threads);
+    ParTest<LockFreeSkipList<int,int,false,reclamation::HazardPointers>> tester6(p, max_level, n, it, num_threads);
+    ParTest<IndexableLockSkipList<int,int,reclamation::HazardPointers>> tester7(p, max_level, n, it, num_threads);
+
+    //compile time bound below the runtime max_level
+    ParTest<LockFreeSkipList<int,int,false,reclamation::EpochBased,16>> tester8(p, max_level, n, it, num_threads);
+
+    //unrolled blocks, small blocks split and merge all the time
+    ParTest<UnrolledLockSkipList<int,int>> tester9(p, max_level, n, it, num_threads);
+    ParTest<UnrolledLockSkipList<int,int,4,reclamation::EpochBased>> tester10(p, max_level, n, it, num_threads);
+
+    test_level_generator(p, max_level, n);
+    test_level_generator(0.25, max_level, n);
+    test_level_generator(0.3, max_level, n);
+
     test_index_seq_skiplist(p,  max_level, n, it);
 
     tester0.test_par_skiplist();
@@ -527,6 +1034,88 @@ int main()
     tester2.test_par_skiplist();
     tester3.test_par_skiplist();
     test_index_par_skiplist(p, max_level, n, it, num_threads);
+    test_parallel_indices(p, max_level, n, it, num_threads);
+    test_parallel_indices(0.25, 16, n, it, num_threads);
+    tester4.test_par_skiplist();
+    tester5.test_par_skiplist();
+    tester6.test_par_skiplist();
+    tester7.test_par_skiplist();
+    tester8.test_par_skiplist();
+    tester9.test_par_skiplist();
+    tester10.test_par_skiplist();
+
+    test_live_index_par_skiplist<IndexableLockSkipList<int,int,reclamation::GarbageQueues,64,true>>(p, max_level, n / 2, it, num_threads);
+    test_live_index_par_skiplist<IndexableLockSkipList<int,int,reclamation::HazardPointers,16,true>>(p, max_level, n / 2, it, num_threads);
+
+    test_churn<LockFreeSkipList<int,int>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<LockFreeSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<LockSkipList<int,int,false,reclamation::EpochBased>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<LockSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<IndexableLockSkipList<int,int,reclamation::HazardPointers>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<UnrolledLockSkipList<int,int>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<UnrolledLockSkipList<int,int,8,reclamation::EpochBased>>(p, max_level, n / 10, 2 * it, num_threads);
+
+    //node locks with backoff, parking waiters and a backoff lock for the garbage queues
+    test_churn<LockSkipList<int,int,false,reclamation::EpochBased,64,lock::BackoffSpinlock<>>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<LockSkipList<int,int,false,reclamation::HazardPointers,64,lock::BackoffSpinlock<true, 64, 16>>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<IndexableLockSkipList<int,int,reclamation::HazardPointers,64,false,lock::BackoffSpinlock<true>>>(p, max_level, n / 10, 2 * it, num_threads);
+    ParTest<LockSkipList<int,int,false,BackoffGarbageQueues,64,lock::BackoffSpinlock<>>>(p, max_level, n, it, num_threads).test_par_skiplist();
+
+    //queue locks, std::mutex as the blocking baseline
+    test_churn<LockSkipList<int,int,false,reclamation::EpochBased,64,lock::MCSLock>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<IndexableLockSkipList<int,int,reclamation::HazardPointers,64,false,lock::MCSLock>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<LockSkipList<int,int,false,reclamation::EpochBased,64,std::mutex>>(p, max_level, n / 10, 2 * it, num_threads);
+    ParTest<IndexableLockSkipList<int,int,reclamation::GarbageQueues,64,false,lock::MCSLock>>(p, max_level, n, it, num_threads).test_par_skiplist();
+    test_churn<UnrolledLockSkipList<int,int,8,reclamation::EpochBased,64,lock::MCSLock>>(p, max_level, n / 10, 2 * it, num_threads);
+    test_churn<UnrolledLockSkipList<int,int,16,reclamation::GarbageQueues,64,lock::BackoffSpinlock<true, 64, 16>>>(p, max_level, n / 10, 2 * it, num_threads);
+    ParTest<LockSkipList2<int,int,64,lock::MCSLock>>(p, max_level, n, it, num_threads).test_par_skiplist();
+
+    test_range_scan<SeqSkipList<int,int>>(p, max_level, n / 10, 1);
+    test_range_scan<IndexableSeqSkipList<int,int>>(p, max_level, n / 10, 1);
+    test_range_scan<LockSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_range_scan<LockSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_range_scan<LockSkipList2<int,int>>(p, max_level, n / 10, num_threads);
+    test_range_scan<LockFreeSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_range_scan<LockFreeSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_range_scan<IndexableLockSkipList<int,int,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_range_scan<UnrolledLockSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_range_scan<UnrolledLockSkipList<int,int,4,reclamation::EpochBased>>(p, max_level, n / 10, num_threads);
+
+    test_bulk_load<SeqSkipList<int,int>>(p, max_level, n);
+    test_bulk_load<IndexableSeqSkipList<int,int>, true>(p, max_level, n);
+    test_bulk_load<LockSkipList<int,int>>(p, max_level, n);
+    test_bulk_load<LockFreeSkipList<int,int>>(0.25, 12, n);
+    test_bulk_load<IndexableLockSkipList<int,int>, true>(p, max_level, n);
+    test_bulk_load<IndexableLockSkipList<int,int,reclamation::GarbageQueues,64,true>, true>(p, 8, n);
+
+    test_insert_batch<LockSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_insert_batch<LockSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_insert_batch<LockFreeSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_insert_batch<LockFreeSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_insert_batch<IndexableLockSkipList<int,int,reclamation::HazardPointers>, true>(p, max_level, n / 10, num_threads);
+    test_insert_batch<IndexableLockSkipList<int,int,reclamation::GarbageQueues,64,true>, true>(p, max_level, n / 10, num_threads);
+
+    test_finger<LockSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_finger<LockSkipList<int,int,false,reclamation::EpochBased>>(p, max_level, n / 10, num_threads);
+    test_finger<LockSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_finger<LockFreeSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_finger<LockFreeSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+
+    test_multi_search<LockSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_multi_search<LockSkipList<int,int,false,reclamation::EpochBased>>(p, max_level, n / 10, num_threads);
+    test_multi_search<LockSkipList<int,int,false,reclamation::HazardPointers>>(p, max_level, n / 10, num_threads);
+    test_multi_search<LockFreeSkipList<int,int>>(p, max_level, n / 10, num_threads);
+    test_multi_search<LockFreeSkipList<int,int,false,reclamation::EpochBased>>(p, max_level, n / 10, num_threads);
+
+    test_pop_min<LockFreeSkipList<int,int>, false>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int>, true>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int,false,reclamation::EpochBased>, true>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int,false,reclamation::HazardPointers>, false>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int,false,reclamation::HazardPointers>, true>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int>, true, true>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int,false,reclamation::EpochBased>, true, true>(p, max_level, n / 10, num_threads);
+    test_pop_min<LockFreeSkipList<int,int>, true, true>(p, max_level, n / 10, 8);
+    test_pop_min<LockFreeSkipList<int,int,false,reclamation::HazardPointers>, true, true>(p, max_level, n / 10, num_threads);
 
     return 0;
 }
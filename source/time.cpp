@@ -8,6 +8,30 @@
 #include <thread>
 #include <atomic>
 #include <memory>
+#include <mutex>
+#include <queue>
+#include <tuple>
+#include <sstream>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+#include <functional>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <map>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <linux/perf_event.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 #include <parallel/algorithm>
 
@@ -23,6 +47,8 @@
 
 #include "implementation/indexable_lock_skiplist.hpp"
 
+#include "implementation/unrolled_lock_skiplist.hpp"
+
 #define V(x) std::string(#x "=") << (x) << " "
 
 
@@ -40,6 +66,555 @@ namespace shuffling {
 }
 /* shuffling */
 
+/* index refresh */
+namespace indexing {
+    struct Sequential {
+        std::string name = "indexable_slist";
+        template<class Slist> void refresh(Slist &slist) { slist.compute_indices(); }
+    };
+
+    struct Parallel {
+        std::string name = "indexable_slist_par";
+        template<class Slist> void refresh(Slist &slist) { slist.compute_indices_parallel(); }
+    };
+
+    struct Incremental {
+        std::string name = "indexable_slist_incremental";
+        template<class Slist> void refresh(Slist &slist) { slist.compute_indices_incremental(); }
+    };
+}
+/* index refresh */
+
+/* latency */
+namespace latency {
+    //cycle counter where it is cheap to read, the histograms convert to nanoseconds only for percentiles
+    inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+
+    //calibrated once against steady_clock
+    inline double ns_per_tick() {
+        static const double factor = [] {
+            auto t1 = std::chrono::steady_clock::now();
+            uint64_t c1 = now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            auto t2 = std::chrono::steady_clock::now();
+            uint64_t c2 = now();
+            return std::chrono::duration<double, std::nano>(t2 - t1).count() / double(c2 - c1);
+        }();
+        return factor;
+    }
+
+    //log-linear buckets, 8 per power of two: exact below 16 ticks, at most 1/8 relative error above
+    //recording is one increment, each thread fills its own histograms and they are merged after the run
+    class Histogram {
+    public:
+        void record(uint64_t ticks) {
+            _counts[bucket(ticks)]++;
+            _total++;
+        }
+
+        void merge(const Histogram &other) {
+            for(size_t i = 0; i < _num_buckets; ++i) _counts[i] += other._counts[i];
+            _total += other._total;
+        }
+
+        //nanoseconds within which the fraction q of all recorded operations finished
+        double percentile(double q) const {
+            if(_total == 0) return 0;
+            uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * _total)));
+            uint64_t seen = 0;
+            for(size_t i = 0; i < _num_buckets; ++i) {
+                seen += _counts[i];
+                if(seen >= rank) return value(i) * ns_per_tick();
+            }
+            return value(_num_buckets - 1) * ns_per_tick();
+        }
+
+    private:
+        static constexpr int _sub_bits = 3;
+        static constexpr uint64_t _sub = 1 << _sub_bits;
+        static constexpr size_t _num_buckets = (64 - _sub_bits + 1) * _sub;
+
+        static size_t bucket(uint64_t v) {
+            if(v < _sub) return v;
+            int e = 63 - __builtin_clzll(v);
+            return (e - _sub_bits) * _sub + _sub + ((v >> (e - _sub_bits)) & (_sub - 1));
+        }
+
+        //middle of the bucket
+        static double value(size_t i) {
+            if(i < 2 * _sub) return i;
+            int shift = i / _sub - 1;
+            uint64_t low = (_sub + i % _sub) << shift;
+            return low + ((uint64_t(1) << shift) - 1) / 2.;
+        }
+
+        std::array<uint64_t, _num_buckets> _counts{};
+        uint64_t _total = 0;
+    };
+
+    struct OpHistograms {
+        Histogram insert, search, remove, scan;
+
+        void merge(const OpHistograms &other) {
+            insert.merge(other.insert);
+            search.merge(other.search);
+            remove.merge(other.remove);
+            scan.merge(other.scan);
+        }
+    };
+
+    template<class Op>
+    void timed(Histogram &h, Op &&op) {
+        uint64_t t1 = now();
+        op();
+        h.record(now() - t1);
+    }
+}
+/* latency */
+
+/* perf counters */
+namespace perf {
+    //reported per operation
+    inline constexpr std::array<const char*, 6> names = {"cycles", "instructions", "l1d_misses", "llc_misses", "dtlb_misses", "branch_misses"};
+
+    //NaN where the event could not be counted
+    using Sample = std::array<double, names.size()>;
+
+    //user space counts of the calling thread and of every thread it starts later (inherit), read as deltas between start and stop
+    //events are opened one by one, the kernel multiplexes them if the cpu has fewer counters and the values are scaled by enabled/running time
+    //inherited counts are folded into the parent when a thread exits, so stop has to come after the join
+    class Counters {
+    public:
+        Counters() {
+            _fds.fill(-1);
+#ifdef __linux__
+            auto cache_miss = [](uint64_t cache) {
+                return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            };
+            const std::array<std::pair<uint32_t, uint64_t>, names.size()> events = {{
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D)},
+                {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL)},
+                {PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB)},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            }};
+            static std::array<bool, names.size()> warned{};
+            for(size_t i = 0; i < names.size(); ++i) {
+                perf_event_attr attr{};
+                attr.size = sizeof(attr);
+                attr.type = events[i].first;
+                attr.config = events[i].second;
+                attr.inherit = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                _fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+                if(_fds[i] < 0 && !warned[i]) {
+                    std::cerr << "perf counter " << names[i] << " unavailable: " << std::strerror(errno) << "\n";
+                    warned[i] = true;
+                }
+            }
+#endif
+            active() = this;
+        }
+
+        ~Counters() {
+#ifdef __linux__
+            for(int fd : _fds) {
+                if(fd >= 0) close(fd);
+            }
+#endif
+            active() = nullptr;
+        }
+
+        Counters(const Counters&) = delete;
+        Counters& operator=(const Counters&) = delete;
+
+        void start() { _begin = read_all(); }
+
+        Sample stop() {
+            auto end = read_all();
+            Sample sample;
+            for(size_t i = 0; i < names.size(); ++i) {
+                uint64_t running = end[i].running - _begin[i].running;
+                if(_fds[i] < 0 || running == 0) {
+                    sample[i] = std::numeric_limits<double>::quiet_NaN();
+                    continue;
+                }
+                uint64_t enabled = end[i].enabled - _begin[i].enabled;
+                sample[i] = double(end[i].value - _begin[i].value) * enabled / running;
+            }
+            return sample;
+        }
+
+        //the counters of the running Runner, nullptr if none
+        static Counters*& active() {
+            static Counters *counters = nullptr;
+            return counters;
+        }
+
+    private:
+        struct Reading {
+            uint64_t value = 0, enabled = 0, running = 0;
+        };
+
+        std::array<Reading, names.size()> read_all() const {
+            std::array<Reading, names.size()> readings{};
+#ifdef __linux__
+            for(size_t i = 0; i < names.size(); ++i) {
+                if(_fds[i] >= 0 && ::read(_fds[i], &readings[i], sizeof(Reading)) != sizeof(Reading)) readings[i] = Reading();
+            }
+#endif
+            return readings;
+        }
+
+        std::array<int, names.size()> _fds;
+        std::array<Reading, names.size()> _begin{};
+    };
+
+    //benchmarks call this where their clock starts, setup before it is left out of the counts
+    //worker threads already waiting at the start are counted as a whole when they exit, their pinning included
+    inline void restart() {
+        if(Counters::active() != nullptr) Counters::active()->start();
+    }
+}
+/* perf counters */
+
+/* placement */
+namespace placement {
+    struct Cpu {
+        int id;
+        int core; //core_id, unique within the package
+        int package;
+        int node;
+    };
+
+    //"0-3,8,10-11" as in sysfs cpu and node lists
+    std::vector<int> parse_list(const std::string &s) {
+        std::vector<int> values;
+        std::stringstream stream(s);
+        std::string part;
+        while(std::getline(stream, part, ',')) {
+            if(part.empty() || part == "\n") continue;
+            size_t dash = part.find('-');
+            int lo = std::stoi(part.substr(0, dash));
+            int hi = dash == std::string::npos ? lo : std::stoi(part.substr(dash + 1));
+            for(int x = lo; x <= hi; ++x) values.push_back(x);
+        }
+        return values;
+    }
+
+    std::string read_line(const std::string &path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+    //online cpus below root (normally /sys/devices/system), missing files fall back to one core per cpu,
+    //one package and the package as numa node
+    std::vector<Cpu> read_topology(const std::string &root) {
+        std::vector<Cpu> cpus;
+        for(int id : parse_list(read_line(root + "/cpu/online"))) {
+            std::string dir = root + "/cpu/cpu" + std::to_string(id) + "/topology/";
+            std::string core = read_line(dir + "core_id"), package = read_line(dir + "physical_package_id");
+            cpus.push_back({id, core.empty() ? id : std::stoi(core), package.empty() ? 0 : std::stoi(package), -1});
+        }
+        for(int node : parse_list(read_line(root + "/node/online"))) {
+            for(int id : parse_list(read_line(root + "/node/node" + std::to_string(node) + "/cpulist"))) {
+                for(auto &c : cpus) {
+                    if(c.id == id) c.node = node;
+                }
+            }
+        }
+        for(auto &c : cpus) {
+            if(c.node < 0) c.node = c.package;
+        }
+        return cpus;
+    }
+
+    //the cpus of this machine the process may run on, read once
+    const std::vector<Cpu>& topology() {
+        static const std::vector<Cpu> cpus = [] {
+            auto all = read_topology("/sys/devices/system");
+#ifdef __linux__
+            cpu_set_t allowed;
+            if(sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+                std::vector<Cpu> usable;
+                for(auto &c : all) {
+                    if(CPU_ISSET(c.id, &allowed)) usable.push_back(c);
+                }
+                if(!usable.empty()) return usable;
+            }
+#endif
+            if(all.empty()) all.push_back({0, 0, 0, 0});
+            return all;
+        }();
+        return cpus;
+    }
+
+    const std::vector<std::string> policies = {"none", "compact", "scatter", "cores", "numa"};
+
+    //cpus each of num_threads threads is bound to, empty sets for none, threads wrap around if there are more than cpus
+    //compact: fill a node core by core, hyperthread siblings next to each other
+    //scatter: round robin over the nodes, a second thread on a core only when every core has one
+    //cores:   one thread per physical core node by node, then the siblings in the same order
+    //numa:    nodes filled as by compact, each thread may run on any cpu of its node
+    std::vector<std::vector<int>> plan(std::vector<Cpu> cpus, const std::string &policy, int num_threads) {
+        std::vector<std::vector<int>> sets(num_threads);
+        if(policy == "none" || cpus.empty()) return sets;
+        //sibling: rank of the cpu on its core, rank: rank of the core on its node
+        std::map<std::pair<int, int>, int> siblings;
+        std::map<int, std::map<std::pair<int, int>, int>> cores;
+        std::sort(cpus.begin(), cpus.end(), [](auto &a, auto &b) { return std::tie(a.node, a.package, a.core, a.id) < std::tie(b.node, b.package, b.core, b.id); });
+        std::vector<std::pair<int, int>> ranks;
+        for(auto &c : cpus) {
+            auto core = std::make_pair(c.package, c.core);
+            auto &on_node = cores[c.node];
+            on_node.emplace(core, int(on_node.size()));
+            ranks.push_back({siblings[core]++, on_node[core]});
+        }
+        std::vector<size_t> order(cpus.size());
+        std::iota(order.begin(), order.end(), 0);
+        if(policy == "scatter") {
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ranks[a] < ranks[b]; });
+        }
+        else if(policy == "cores") {
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return ranks[a].first < ranks[b].first; });
+        }
+        for(int t = 0; t < num_threads; ++t) {
+            auto &cpu = cpus[order[t % order.size()]];
+            if(policy != "numa") {
+                sets[t].push_back(cpu.id);
+                continue;
+            }
+            for(auto &c : cpus) {
+                if(c.node == cpu.node) sets[t].push_back(c.id);
+            }
+        }
+        return sets;
+    }
+
+    //set by main from --pin, the benchmarks only get the number of threads
+    std::string& policy() {
+        static std::string p = "none";
+        return p;
+    }
+
+    //cpu sets of the threads of one run, planned before they start, each thread binds itself before the clock starts
+    class Pinning {
+    public:
+        explicit Pinning(int num_threads) : _sets(plan(topology(), policy(), num_threads)) {}
+
+        //binds the calling thread as thread t
+        void pin(int t) const {
+            if(_sets[t].empty()) return;
+#ifdef __linux__
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            for(int id : _sets[t]) CPU_SET(id, &mask);
+            pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+#endif
+        }
+
+    private:
+        std::vector<std::vector<int>> _sets;
+    };
+
+    //one entry per thread, the cpu or the node for numa
+    std::string describe(int num_threads) {
+        auto sets = plan(topology(), policy(), num_threads);
+        std::string out;
+        for(auto &set : sets) {
+            if(!out.empty()) out += " ";
+            if(set.empty()) out += "-";
+            else if(policy() == "numa") out += "node" + std::to_string(std::find_if(topology().begin(), topology().end(), [&](auto &c) { return c.id == set[0]; }) -> node);
+            else out += std::to_string(set[0]);
+        }
+        return out;
+    }
+}
+/* placement */
+
+/* ycsb */
+namespace ycsb {
+    //operation mix and key distribution of the ycsb workload, read is search, update inserts an existing key
+    struct Spec {
+        double read = 0.95, update = 0.05, insert = 0, remove = 0, scan = 0;
+        int scan_length = 100;
+        std::string distribution = "zipfian"; //uniform, zipfian, hotspot or latest
+        double theta = 0.99;
+        double hot_set = 0.2, hot_ops = 0.8; //hotspot: fraction of the keys that gets the fraction hot_ops of the operations
+        double duration = 1.0; //seconds of steady state after the preload
+    };
+
+    //the benchmark interface only passes the number of threads, the driver sets the spec before running
+    inline Spec& spec() {
+        static Spec s;
+        return s;
+    }
+
+    //presets of the ycsb core workloads, f (read-modify-write) runs as read plus update
+    inline bool preset(Spec &s, const std::string &name) {
+        auto mix = [&](double read, double update, double insert, double scan, std::string distribution) {
+            s.read = read; s.update = update; s.insert = insert; s.remove = 0; s.scan = scan;
+            s.distribution = distribution;
+        };
+        if(name == "a") mix(0.5, 0.5, 0, 0, "zipfian");
+        else if(name == "b") mix(0.95, 0.05, 0, 0, "zipfian");
+        else if(name == "c") mix(1, 0, 0, 0, "zipfian");
+        else if(name == "d") mix(0.95, 0, 0.05, 0, "latest");
+        else if(name == "e") mix(0, 0, 0.05, 0.95, "zipfian");
+        else if(name == "f") mix(0.5, 0.5, 0, 0, "zipfian");
+        else return false;
+        return true;
+    }
+
+    inline double uniform() {
+        return (random_gen::next() >> 11) * 0x1.0p-53;
+    }
+
+    //Gray et al., "Quickly generating billion-record synthetic databases", ranks in [0, n), rank 0 is the most popular
+    //the closed form only holds for 0 < theta < 1
+    class Zipfian {
+    public:
+        Zipfian(uint64_t n, double theta) : _n(n), _theta(theta) {
+            _zetan = zeta(n, theta);
+            double zeta2 = zeta(2, theta);
+            _alpha = 1 / (1 - theta);
+            _eta = (1 - std::pow(2. / n, 1 - theta)) / (1 - zeta2 / _zetan);
+        }
+
+        uint64_t operator()() const {
+            double u = uniform();
+            double uz = u * _zetan;
+            if(uz < 1) return 0;
+            if(uz < 1 + std::pow(0.5, _theta)) return 1;
+            return std::min<uint64_t>(_n - 1, _n * std::pow(_eta * u - _eta + 1, _alpha));
+        }
+
+    private:
+        static double zeta(uint64_t n, double theta) {
+            double sum = 0;
+            for(uint64_t i = 1; i <= n; ++i) sum += 1 / std::pow(double(i), theta);
+            return sum;
+        }
+
+        uint64_t _n;
+        double _theta, _zetan, _alpha, _eta;
+    };
+
+    //fnv-1a, spreads the popular zipfian ranks over the key space
+    inline uint64_t scramble(uint64_t x) {
+        uint64_t h = 0xcbf29ce484222325;
+        for(int i = 0; i < 8; ++i) {
+            h ^= (x >> (8 * i)) & 0xff;
+            h *= 0x100000001b3;
+        }
+        return h;
+    }
+
+    //draws keys from [0, count), count grows with the inserts of the steady state
+    class KeyChooser {
+    public:
+        KeyChooser(const Spec &s, uint64_t n) : _spec(s), _zipf(std::max<uint64_t>(n, 2), s.theta) {}
+
+        int_type operator()(uint64_t count) const {
+            auto &d = _spec.distribution;
+            if(d == "uniform") {
+                return random_gen::next() % count;
+            }
+            if(d == "hotspot") {
+                uint64_t hot = std::max<uint64_t>(1, _spec.hot_set * count);
+                if(uniform() < _spec.hot_ops || hot == count) return random_gen::next() % hot;
+                return hot + random_gen::next() % (count - hot);
+            }
+            if(d == "latest") {
+                uint64_t back = _zipf();
+                return back < count ? count - 1 - back : 0;
+            }
+            return scramble(_zipf()) % count;
+        }
+
+    private:
+        const Spec &_spec;
+        Zipfian _zipf;
+    };
+
+    //throws std::invalid_argument for unknown distributions, ratios that do not sum up to one or theta outside (0, 1)
+    inline void validate(const Spec &s) {
+        auto &d = s.distribution;
+        if(d != "uniform" && d != "zipfian" && d != "hotspot" && d != "latest") throw std::invalid_argument("unknown distribution " + d);
+        double sum = s.read + s.update + s.insert + s.remove + s.scan;
+        if(std::abs(sum - 1) > 1e-6) throw std::invalid_argument("operation ratios must sum up to 1");
+        if(!(s.theta > 0 && s.theta < 1)) throw std::invalid_argument("theta must be in (0, 1)");
+        if(s.duration <= 0) throw std::invalid_argument("duration must be positive");
+    }
+}
+/* ycsb */
+
+/* priority queues */
+namespace queueing {
+    //std::priority_queue behind a mutex with the constructor and pop interface of the skiplists
+    template<class Key, class Value>
+    class MutexPriorityQueue {
+    public:
+        MutexPriorityQueue(const double, const int) {}
+
+        void insert(Key key, Value value) {
+            std::lock_guard<std::mutex> guard(_mutex);
+            _queue.push({key, value});
+        }
+
+        std::tuple<bool, Key, Value> pop_min() {
+            std::lock_guard<std::mutex> guard(_mutex);
+            if(_queue.empty()) {
+                return {false, Key(), Value()};
+            }
+            auto[key, value] = _queue.top();
+            _queue.pop();
+            return {true, key, value};
+        }
+
+    private:
+        std::mutex _mutex;
+        std::priority_queue<std::pair<Key, Value>, std::vector<std::pair<Key, Value>>, std::greater<std::pair<Key, Value>>> _queue;
+    };
+
+    struct Strict {
+        template<class Queue> struct Handle {
+            Handle(Queue &, int) {}
+            auto pop(Queue &queue) { return queue.pop_min(); }
+        };
+    };
+
+    struct Batched {
+        template<class Queue> struct Handle {
+            Handle(Queue &queue, int) : _batch(queue.pop_batch()) {}
+            auto pop(Queue &queue) { return queue.pop_min(_batch); }
+            decltype(std::declval<Queue&>().pop_batch()) _batch;
+        };
+    };
+
+    //relaxed, the spray width grows with the number of threads
+    struct Spray {
+        template<class Queue> struct Handle {
+            Handle(Queue &queue, int num_threads) : _batch(queue.pop_batch()), _num_threads(num_threads) {}
+            auto pop(Queue &queue) { return queue.spray_pop(_batch, _num_threads); }
+            decltype(std::declval<Queue&>().pop_batch()) _batch;
+            int _num_threads;
+        };
+    };
+}
+/* priority queues */
+
 std::vector<std::vector<int_type>> distribute_work(std::vector<int> &v, int _num_threads) {
     std::vector<std::vector<int_type>> to_insert(_num_threads);
     for(uint i = 0; i < v.size(); ++i) {
@@ -50,6 +625,25 @@ std::vector<std::vector<int_type>> distribute_work(std::vector<int> &v, int _num
 
 /* benchmark */
 namespace benchmark {
+    //workers wait here once their setup (pinning) is done, the clock starts after all of them arrived
+    class StartGate {
+    public:
+        void wait() {
+            _ready.fetch_add(1);
+            while(!_open.load(std::memory_order_acquire)) std::this_thread::yield();
+        }
+
+        void wait_ready(int num_threads) {
+            while(_ready.load() < num_threads) std::this_thread::yield();
+        }
+
+        void open() { _open.store(true, std::memory_order_release); }
+
+    private:
+        std::atomic<int> _ready{0};
+        std::atomic<bool> _open{false};
+    };
+
     template<class Slist, class ShuffleType, class Benchmark> 
     class Runner {
      public:
@@ -86,6 +680,61 @@ namespace benchmark {
             }
             return all_data;
         }
+
+        std::vector<std::pair<double, latency::OpHistograms>> run_latency() {
+            ShuffleType shf;
+            Benchmark benchmark(_num_threads);
+            std::vector<int_type> v(_n);
+            std::iota(v.begin(), v.end(), 0);
+            std::vector<std::pair<double, latency::OpHistograms>> all_data;
+            for(int i = 0; i < _iterations; ++i) {
+                shf.shuffle(v);
+                Slist slist(_p, _max_level);
+                all_data.push_back(benchmark.run_with_latency(slist, v));
+            }
+            return all_data;
+        }
+
+        //time and number of operations, for time bounded benchmarks
+        std::vector<std::pair<double, size_t>> run_throughput() {
+            ShuffleType shf;
+            Benchmark benchmark(_num_threads);
+            std::vector<int_type> v(_n);
+            std::iota(v.begin(), v.end(), 0);
+            std::vector<std::pair<double, size_t>> all_data;
+            for(int i = 0; i < _iterations; ++i) {
+                shf.shuffle(v);
+                Slist slist(_p, _max_level);
+                all_data.push_back(benchmark.run_with_ops(slist, v));
+            }
+            return all_data;
+        }
+
+        //time, number of operations and hardware counters, the counters are opened before any benchmark thread starts
+        std::vector<std::tuple<double, size_t, perf::Sample>> run_counters() {
+            ShuffleType shf;
+            Benchmark benchmark(_num_threads);
+            std::vector<int_type> v(_n);
+            std::iota(v.begin(), v.end(), 0);
+            perf::Counters counters;
+            std::vector<std::tuple<double, size_t, perf::Sample>> all_data;
+            for(int i = 0; i < _iterations; ++i) {
+                shf.shuffle(v);
+                Slist slist(_p, _max_level);
+                counters.start();
+                double time;
+                size_t ops;
+                if constexpr(requires { benchmark.run_with_ops(slist, v); }) {
+                    std::tie(time, ops) = benchmark.run_with_ops(slist, v);
+                }
+                else {
+                    time = benchmark.run_with(slist, v);
+                    ops = benchmark.operations(v.size());
+                }
+                all_data.push_back({time, ops, counters.stop()});
+            }
+            return all_data;
+        }
     private:
         const double _p;
         const int _max_level;
@@ -103,10 +752,13 @@ namespace benchmark {
             auto work_threads = distribute_work(v, _num_threads);
             std::vector<std::thread> threads;
             std::atomic<bool> complete = true;
-            auto t1 = std::chrono::high_resolution_clock::now();
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
             //1:1:3
             for(int t = 0; t < _num_threads; ++t) {
                 threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
                     for(auto &x : work_threads[t]) {
                         slist.insert(x, x);
                         slist.search(x);
@@ -120,6 +772,10 @@ namespace benchmark {
                     }
                 });
             }
+            gate.wait_ready(_num_threads);
+            perf::restart();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
             for(auto &t : threads) {
                 t.join();
             }
@@ -134,10 +790,13 @@ namespace benchmark {
             std::vector<std::thread> threads;
             std::atomic<bool> complete = true;
             std::atomic<size_t> total_op{0};
-            auto t1 = std::chrono::high_resolution_clock::now();
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
             //1:1:3
             for(int t = 0; t < _num_threads; ++t) {
                 threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
                     for(auto &x : work_threads[t]) {
                         slist.insert(x, x);
                         slist.search(x);
@@ -152,6 +811,233 @@ namespace benchmark {
                     total_op += 5 * work_threads[t].size();
                 });
             }
+            gate.wait_ready(_num_threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            auto [find, find_retry] = slist.collect_counter();
+            return {time, find, find_retry, total_op.load()};
+        }
+
+        //same operations, each one timed into the histograms of its thread
+        std::pair<double, latency::OpHistograms> run_with_latency(Slist &slist, std::vector<int_type> &v) {
+            auto work_threads = distribute_work(v, _num_threads);
+            std::vector<std::thread> threads;
+            std::vector<latency::OpHistograms> histograms(_num_threads);
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    latency::OpHistograms local;
+                    for(auto &x : work_threads[t]) {
+                        latency::timed(local.insert, [&] { slist.insert(x, x); });
+                        latency::timed(local.search, [&] { slist.search(x); });
+                    }
+                    for(auto &x : work_threads[t]) {
+                        latency::timed(local.search, [&] { slist.search(x); });
+                    }
+                    for(auto &x : work_threads[t]) {
+                        latency::timed(local.search, [&] { slist.search(x); });
+                        latency::timed(local.remove, [&] { slist.remove(x); });
+                    }
+                    histograms[t] = local;
+                });
+            }
+            gate.wait_ready(_num_threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            for(int t = 1; t < _num_threads; ++t) {
+                histograms[0].merge(histograms[t]);
+            }
+            return {time, histograms[0]};
+        }
+
+        size_t operations(size_t n) const { return 5 * n; }
+
+        int _num_threads;
+    };
+
+    //threads have same elements
+    template<class Slist>
+    struct BenchmarkShared {
+        BenchmarkShared(int num_threads) : _num_threads(num_threads) {};
+
+        double run_with(Slist &slist, std::vector<int_type> &v) {
+            std::vector<std::thread> threads;
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    for(auto &x : v) {
+                        slist.insert(x, x);
+                        slist.search(x);
+                    }
+                    for(auto &x : v) {
+                        slist.search(x);
+                    }
+                    for(auto &x : v) {
+                        slist.search(x);
+                        slist.remove(x);
+                    }
+                });
+            }
+            gate.wait_ready(_num_threads);
+            perf::restart();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            return time;
+        }
+
+        std::tuple<double, size_t, size_t, size_t> run_with_metric(Slist &slist, std::vector<int_type> &v) {
+            std::vector<std::thread> threads;
+            std::atomic<size_t> total_op{0};
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            //1:1:3
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    for(auto &x : v) {
+                        slist.insert(x, x);
+                        slist.search(x);
+                    }
+                    for(auto &x : v) {
+                        slist.search(x);
+                    }
+                    for(auto &x : v) {
+                        slist.search(x);
+                        slist.remove(x);
+                    }
+                    total_op += 5 * v.size();
+                });
+            }
+            gate.wait_ready(_num_threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            auto [find, find_retry] = slist.collect_counter();
+            return {time, find, find_retry, total_op.load()};
+        }
+
+        std::pair<double, latency::OpHistograms> run_with_latency(Slist &slist, std::vector<int_type> &v) {
+            std::vector<std::thread> threads;
+            std::vector<latency::OpHistograms> histograms(_num_threads);
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    latency::OpHistograms local;
+                    for(auto &x : v) {
+                        latency::timed(local.insert, [&] { slist.insert(x, x); });
+                        latency::timed(local.search, [&] { slist.search(x); });
+                    }
+                    for(auto &x : v) {
+                        latency::timed(local.search, [&] { slist.search(x); });
+                    }
+                    for(auto &x : v) {
+                        latency::timed(local.search, [&] { slist.search(x); });
+                        latency::timed(local.remove, [&] { slist.remove(x); });
+                    }
+                    histograms[t] = local;
+                });
+            }
+            gate.wait_ready(_num_threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            for(int t = 1; t < _num_threads; ++t) {
+                histograms[0].merge(histograms[t]);
+            }
+            return {time, histograms[0]};
+        }
+
+        size_t operations(size_t n) const { return 5 * n * _num_threads; }
+
+        int _num_threads;
+    };
+
+    //threads do not share elements, each thread ingests its elements in sorted runs of batch_size
+    //with batched the runs go through insert_batch, else every key is inserted on its own
+    template<class Slist, bool batched, size_t batch_size = 256>
+    struct BenchmarkIngest {
+        BenchmarkIngest(int num_threads) : _num_threads(num_threads) {};
+
+        double run_with(Slist &slist, std::vector<int_type> &v) {
+            auto work_threads = sorted_runs(v);
+            std::vector<std::thread> threads;
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    ingest(slist, work_threads[t]);
+                });
+            }
+            gate.wait_ready(_num_threads);
+            perf::restart();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            for(auto &t : threads) {
+                t.join();
+            }
+            threads.clear();
+            auto t2 = std::chrono::high_resolution_clock::now();
+            auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
+            return time;
+        }
+
+        std::tuple<double, size_t, size_t, size_t> run_with_metric(Slist &slist, std::vector<int_type> &v) {
+            auto work_threads = sorted_runs(v);
+            std::vector<std::thread> threads;
+            std::atomic<size_t> total_op{0};
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    gate.wait();
+                    ingest(slist, work_threads[t]);
+                    total_op += work_threads[t].size();
+                });
+            }
+            gate.wait_ready(_num_threads);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
             for(auto &t : threads) {
                 t.join();
             }
@@ -161,72 +1047,196 @@ namespace benchmark {
             auto [find, find_retry] = slist.collect_counter();
             return {time, find, find_retry, total_op.load()};
         }
+
+        std::vector<std::vector<std::pair<int_type, int_type>>> sorted_runs(std::vector<int_type> &v) {
+            auto work_threads = distribute_work(v, _num_threads);
+            std::vector<std::vector<std::pair<int_type, int_type>>> runs(_num_threads);
+            for(int t = 0; t < _num_threads; ++t) {
+                auto &w = work_threads[t];
+                for(size_t i = 0; i < w.size(); i += batch_size) {
+                    std::sort(w.begin() + i, w.begin() + std::min(i + batch_size, w.size()));
+                }
+                for(auto &x : w) {
+                    runs[t].push_back({x, x});
+                }
+            }
+            return runs;
+        }
+
+        void ingest(Slist &slist, std::vector<std::pair<int_type, int_type>> &pairs) {
+            for(size_t i = 0; i < pairs.size(); i += batch_size) {
+                auto first = pairs.begin() + i;
+                auto last = pairs.begin() + std::min(i + batch_size, pairs.size());
+                if constexpr(batched) {
+                    slist.insert_batch(first, last);
+                }
+                else {
+                    for(auto it = first; it != last; ++it) {
+                        slist.insert(it -> first, it -> second);
+                    }
+                }
+            }
+        }
+
+        size_t operations(size_t n) const { return n; }
+
         int _num_threads;
     };
 
-    //threads have same elements
+    //ycsb::spec() mix, v is loaded in parallel before the clock starts, then all threads run the mix for a fixed duration
     template<class Slist>
-    struct BenchmarkShared {
-        BenchmarkShared(int num_threads) : _num_threads(num_threads) {};
+    struct BenchmarkYcsb {
+        BenchmarkYcsb(int num_threads) : _num_threads(num_threads), _spec(ycsb::spec()) {};
 
-        double run_with(Slist &slist, std::vector<int_type> &v) {
+        std::pair<double, size_t> run_with_ops(Slist &slist, std::vector<int_type> &v) {
+            auto [time, ops, histograms] = execute<false>(slist, v);
+            return {time, ops};
+        }
+
+        //reads count as search, updates and inserts as insert, scans get their own histogram
+        std::pair<double, latency::OpHistograms> run_with_latency(Slist &slist, std::vector<int_type> &v) {
+            auto [time, ops, histograms] = execute<true>(slist, v);
+            return {time, histograms};
+        }
+
+        template<bool timed>
+        std::tuple<double, size_t, latency::OpHistograms> execute(Slist &slist, std::vector<int_type> &v) {
+            auto work_threads = distribute_work(v, _num_threads);
             std::vector<std::thread> threads;
-            auto t1 = std::chrono::high_resolution_clock::now();
+            placement::Pinning pinning(_num_threads); //the preload is pinned too, pages are first touched where they are used
             for(int t = 0; t < _num_threads; ++t) {
                 threads.emplace_back([&, t] {
-                    for(auto &x : v) {
-                        slist.insert(x, x);
-                        slist.search(x);
-                    }
-                    for(auto &x : v) {
-                        slist.search(x);
-                    }
-                    for(auto &x : v) {
-                        slist.search(x);
-                        slist.remove(x);
-                    }
+                    pinning.pin(t);
+                    for(auto &x : work_threads[t]) slist.insert(x, x);
                 });
             }
             for(auto &t : threads) {
                 t.join();
             }
             threads.clear();
+
+            ycsb::KeyChooser choose(_spec, v.size());
+            std::atomic<uint64_t> count = v.size(); //keys above count are free for inserts
+            StartGate gate;
+            std::atomic<bool> stop = false;
+            std::atomic<size_t> total_ops = 0;
+            std::vector<latency::OpHistograms> histograms(timed ? _num_threads : 0);
+            const double read = _spec.read, update = read + _spec.update, insert = update + _spec.insert, remove = insert + _spec.remove;
+            for(int t = 0; t < _num_threads; ++t) {
+                threads.emplace_back([&, t] {
+                    pinning.pin(t);
+                    latency::OpHistograms local;
+                    auto op = [&](latency::Histogram &h, auto &&f) {
+                        if constexpr(timed) latency::timed(h, f);
+                        else f();
+                    };
+                    size_t ops = 0;
+                    gate.wait();
+                    while(!stop.load(std::memory_order_relaxed)) {
+                        for(int b = 0; b < 64; ++b) {
+                            double u = ycsb::uniform();
+                            if(u < read) {
+                                int_type key = choose(count.load(std::memory_order_relaxed));
+                                op(local.search, [&] { slist.search(key); });
+                            }
+                            else if(u < update) {
+                                int_type key = choose(count.load(std::memory_order_relaxed));
+                                int_type value = key + 1;
+                                op(local.insert, [&] { slist.insert(key, value); });
+                            }
+                            else if(u < insert) {
+                                int_type key = count.fetch_add(1);
+                                op(local.insert, [&] { slist.insert(key, key); });
+                            }
+                            else if(u < remove) {
+                                int_type key = choose(count.load(std::memory_order_relaxed));
+                                op(local.remove, [&] { slist.remove(key); });
+                            }
+                            else {
+                                int_type key = choose(count.load(std::memory_order_relaxed));
+                                op(local.scan, [&] { scan(slist, key); });
+                            }
+                        }
+                        ops += 64;
+                    }
+                    total_ops += ops;
+                    if constexpr(timed) histograms[t] = local;
+                });
+            }
+            gate.wait_ready(_num_threads);
+            perf::restart();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
+            std::this_thread::sleep_for(std::chrono::duration<double>(_spec.duration));
+            stop = true;
+            for(auto &t : threads) {
+                t.join();
+            }
             auto t2 = std::chrono::high_resolution_clock::now();
             auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
-            return time;
+            latency::OpHistograms merged;
+            for(auto &h : histograms) {
+                merged.merge(h);
+            }
+            return {time, total_ops.load(), merged};
         }
 
-        std::tuple<double, size_t, size_t, size_t> run_with_metric(Slist &slist, std::vector<int_type> &v) {
+        void scan(Slist &slist, int_type key) {
+            if constexpr(requires { slist.lower_bound(key).valid(); }) {
+                auto cur = slist.lower_bound(key);
+                for(int i = 0; i < _spec.scan_length && cur.valid(); ++i, ++cur) {}
+            }
+        }
+
+        int _num_threads;
+        const ycsb::Spec &_spec;
+    };
+
+    //scheduler pattern, threads prefill half of their elements, then alternate insert and pop_min, then drain
+    template<class Queue, class PopType = queueing::Strict>
+    struct BenchmarkPriorityQueue {
+        BenchmarkPriorityQueue(int num_threads) : _num_threads(num_threads) {};
+
+        double run_with(Queue &queue, std::vector<int_type> &v) {
+            auto work_threads = distribute_work(v, _num_threads);
             std::vector<std::thread> threads;
-            std::atomic<size_t> total_op{0};
-            auto t1 = std::chrono::high_resolution_clock::now();
-            //1:1:3
+            placement::Pinning pinning(_num_threads);
+            StartGate gate;
             for(int t = 0; t < _num_threads; ++t) {
                 threads.emplace_back([&, t] {
-                    for(auto &x : v) {
-                        slist.insert(x, x);
-                        slist.search(x);
+                    pinning.pin(t);
+                    gate.wait();
+                    typename PopType::template Handle<Queue> handle(queue, _num_threads);
+                    auto &w = work_threads[t];
+                    size_t half = w.size() / 2;
+                    for(size_t i = 0; i < half; ++i) {
+                        queue.insert(w[i], w[i]);
                     }
-                    for(auto &x : v) {
-                        slist.search(x);
+                    for(size_t i = half; i < w.size(); ++i) {
+                        queue.insert(w[i], w[i]);
+                        handle.pop(queue);
                     }
-                    for(auto &x : v) {
-                        slist.search(x);
-                        slist.remove(x);
+                    for(size_t i = 0; i < half; ++i) {
+                        handle.pop(queue);
                     }
-                    total_op += 5 * v.size();
                 });
             }
+            gate.wait_ready(_num_threads);
+            perf::restart();
+            auto t1 = std::chrono::high_resolution_clock::now();
+            gate.open();
             for(auto &t : threads) {
                 t.join();
             }
             threads.clear();
             auto t2 = std::chrono::high_resolution_clock::now();
             auto time = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count() / 1000.;
-            auto [find, find_retry] = slist.collect_counter();
-            return {time, find, find_retry, total_op.load()};
+            return time;
         }
 
+        //every element is inserted and popped once
+        size_t operations(size_t n) const { return 2 * n; }
+
         int _num_threads;
     };
 }
@@ -349,6 +1359,193 @@ namespace printer {
         }
     }
 
+    //time columns followed by p50, p99 and p99.9 in nanoseconds for insert, search, remove and scan
+    void print_headline4(std::ostream& out) {
+        print(out, "#it"    , 15);
+        print(out, "threads", 15);
+        print(out, "n", 15);
+        print(out, "p", 15);
+        print(out, "max_level", 15);
+        print(out, "sorting", 15);
+        print(out, "benchmark", 15);
+        print(out, "variant", 15);
+        print(out, "time", 15);
+        for(auto op : {"insert", "search", "remove", "scan"}) {
+            for(auto q : {"p50", "p99", "p999"}) {
+                print(out, std::string(op) + "_" + q, 15);
+            }
+        }
+        out       << std::endl;
+        std::cout << std::endl;
+    }
+
+    void print_latency(std::ostream& out,
+                      int it, int t, int n, double p, int lv, std::string &srt, std::string &bench, std::string &var, double time,
+                      latency::OpHistograms &h) {
+        print(out, it  , 15);
+        print(out, t, 15);
+        print(out, n, 15);
+        print(out, p, 15);
+        print(out, lv, 15);
+        print(out, srt, 15);
+        print(out, bench, 15);
+        print(out, var, 15);
+        print(out, time, 15);
+        for(auto *op : {&h.insert, &h.search, &h.remove, &h.scan}) {
+            for(double q : {0.5, 0.99, 0.999}) {
+                print(out, op -> percentile(q), 15);
+            }
+        }
+        out       << std::endl;
+        std::cout << std::endl;
+    }
+
+    template<class RunnerType> 
+    void run_latency(std::ofstream &file,
+     int it, std::vector<int> &ts, std::vector<double> &ps, std::vector<int> &max_levels, std::vector<int> &ns,
+     std::string &sort, std::string &benchmark, std::string &variant) {
+        for(auto &t : ts) {
+            for(auto &p : ps) {
+                for(auto &max_lv : max_levels) {
+                    for(auto &n : ns) {
+                        RunnerType runner(p, max_lv, n, it, t);
+                        auto data = runner.run_latency();
+                        int it_nr = 1;
+                        for(auto &[time, histograms] : data) {
+                            print_latency(file, it_nr, t, n, p, max_lv, sort, benchmark, variant, time, histograms);
+                            it_nr++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //time bounded runs: time is the measured steady state, throughput in million operations per second
+    void print_headline5(std::ostream& out) {
+        print(out, "#it"    , 15);
+        print(out, "threads", 15);
+        print(out, "n", 15);
+        print(out, "p", 15);
+        print(out, "max_level", 15);
+        print(out, "sorting", 15);
+        print(out, "benchmark", 15);
+        print(out, "variant", 15);
+        print(out, "time", 15);
+        print(out, "ops", 15);
+        print(out, "mops", 15);
+        out       << std::endl;
+        std::cout << std::endl;
+    }
+
+    template<class RunnerType> 
+    void run_throughput(std::ofstream &file,
+     int it, std::vector<int> &ts, std::vector<double> &ps, std::vector<int> &max_levels, std::vector<int> &ns,
+     std::string &sort, std::string &benchmark, std::string &variant) {
+        for(auto &t : ts) {
+            for(auto &p : ps) {
+                for(auto &max_lv : max_levels) {
+                    for(auto &n : ns) {
+                        RunnerType runner(p, max_lv, n, it, t);
+                        auto data = runner.run_throughput();
+                        int it_nr = 1;
+                        for(auto &[time, ops] : data) {
+                            print(file, it_nr, 15);
+                            print(file, t, 15);
+                            print(file, n, 15);
+                            print(file, p, 15);
+                            print(file, max_lv, 15);
+                            print(file, sort, 15);
+                            print(file, benchmark, 15);
+                            print(file, variant, 15);
+                            print(file, time, 15);
+                            print(file, ops, 15);
+                            print(file, ops / time / 1000, 15);
+                            file      << std::endl;
+                            std::cout << std::endl;
+                            it_nr++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //time and ops as for throughput, then the perf counters per operation, NA where an event could not be counted
+    void print_headline6(std::ostream& out) {
+        print(out, "#it"    , 15);
+        print(out, "threads", 15);
+        print(out, "n", 15);
+        print(out, "p", 15);
+        print(out, "max_level", 15);
+        print(out, "sorting", 15);
+        print(out, "benchmark", 15);
+        print(out, "variant", 15);
+        print(out, "time", 15);
+        print(out, "ops", 15);
+        for(auto name : perf::names) {
+            print(out, name, 15);
+        }
+        out       << std::endl;
+        std::cout << std::endl;
+    }
+
+    template<class RunnerType> 
+    void run_counters(std::ofstream &file,
+     int it, std::vector<int> &ts, std::vector<double> &ps, std::vector<int> &max_levels, std::vector<int> &ns,
+     std::string &sort, std::string &benchmark, std::string &variant) {
+        for(auto &t : ts) {
+            for(auto &p : ps) {
+                for(auto &max_lv : max_levels) {
+                    for(auto &n : ns) {
+                        RunnerType runner(p, max_lv, n, it, t);
+                        auto data = runner.run_counters();
+                        int it_nr = 1;
+                        for(auto &[time, ops, sample] : data) {
+                            print(file, it_nr, 15);
+                            print(file, t, 15);
+                            print(file, n, 15);
+                            print(file, p, 15);
+                            print(file, max_lv, 15);
+                            print(file, sort, 15);
+                            print(file, benchmark, 15);
+                            print(file, variant, 15);
+                            print(file, time, 15);
+                            print(file, ops, 15);
+                            for(double value : sample) {
+                                if(std::isnan(value)) print(file, "NA", 15);
+                                else print(file, value / ops, 15);
+                            }
+                            file      << std::endl;
+                            std::cout << std::endl;
+                            it_nr++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    //comment lines below the headline, the plot script skips them
+    void print_placement(std::ostream& out, std::vector<int> &ts) {
+        auto &cpus = placement::topology();
+        std::map<std::pair<int, int>, int> cores;
+        std::map<int, int> nodes;
+        for(auto &c : cpus) {
+            cores[{c.package, c.core}]++;
+            nodes[c.node]++;
+        }
+        std::stringstream line;
+        line << "# pin " << placement::policy() << ", " << cpus.size() << " cpus, " << cores.size() << " cores, " << nodes.size() << " numa nodes\n";
+        if(placement::policy() != "none") {
+            for(int t : ts) {
+                line << "# threads " << t << ": " << placement::describe(t) << "\n";
+            }
+        }
+        out       << line.str();
+        std::cout << line.str();
+    }
+
     void print_headline3(std::ostream& out) {
         print(out, "#it"    , 12);
         print(out, "sec"    , 12);
@@ -380,11 +1577,12 @@ namespace printer {
         std::cout << std::endl;
     }
 
-    template<class ShuffleType> 
+    template<class ShuffleType, class IndexType = indexing::Sequential> 
     void run_index_benchmark(std::ofstream &file,
      int it, int n, int sections, std::vector<int> &ts, std::string &sort) {
         std::string benchmark = "disjoint";
-        std::string variant = "indexable_slist";
+        IndexType indexing;
+        std::string variant = indexing.name;
         double p = 0.5;
         int max_level = 32;
         
@@ -400,9 +1598,9 @@ namespace printer {
                 std::vector<std::thread> threads;
                 double total_time = 0;
 
-                for(uint s = 1; s <= sections; ++s) {
+                for(uint s = 1; s <= uint(sections); ++s) {
                     auto t1 = std::chrono::high_resolution_clock::now();
-                    for(uint t = 0; t < _num_threads; ++t) {
+                    for(int t = 0; t < _num_threads; ++t) {
                         threads.emplace_back([&, t] {
                             uint size = work_threads[t].size();
                             uint batch = size / sections;
@@ -417,7 +1615,7 @@ namespace printer {
                     }
                     threads.clear();
 
-                    slist.compute_indices();
+                    indexing.refresh(slist);
 
                     for(int t = 0; t < _num_threads; ++t) {
                         threads.emplace_back([&, t] {
@@ -519,192 +1717,406 @@ namespace printer {
 }
 /* printer */
 
-int main()
-{
-    // uncomment to run benmark
+/* driver */
+namespace driver {
+    //bad command line, main prints the message and the usage
+    struct ArgumentError : std::invalid_argument {
+        using std::invalid_argument::invalid_argument;
+    };
 
-    // using SlistLock = LockSkipList<int_type, int_type>;
-    // using SlistLock2 = LockFreeSkipList<int_type, int_type>;
-    // using SlistLock3 = LockSkipList2<int_type, int_type>; //with shared ptr
-    // using SlistLock4 = SeqSkipList<int_type, int_type>;
+    struct Config {
+        std::vector<std::string> variants = {"lock"};
+        std::string workload = "disjoint";
+        std::string shuffle = "permutation";
+        std::vector<int> ns = {1000000};
+        std::vector<double> ps = {0.5};
+        std::vector<int> max_levels = {32};
+        std::vector<int> ts = {1,2,3,4,5,6,7,8,9,10,11,12};
+        std::vector<int> sections = {1, 10, 100, 1000}; //rank workload only
+        int it = 5;
+        std::string out = "benchmark.txt";
+        bool metric = false;
+        bool latency = false; //per operation percentiles, workloads disjoint, shared and ycsb
+        bool counters = false; //perf counters per operation, all workloads but rank
+        std::string pin = "none"; //see placement::plan
+        ycsb::Spec ycsb;
+        std::string label; //benchmark column, the workload or ycsb_ with the key distribution
+        bool list = false;
+        bool help = false;
+    };
 
-    // using Runner1 = benchmark::Runner<SlistLock, shuffling::Permutation, benchmark::BenchmarkDisjoint<SlistLock>>;
-    // using Runner2 = benchmark::Runner<SlistLock, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SlistLock>>;
-    // using Runner3 = benchmark::Runner<SlistLock, shuffling::Permutation, benchmark::BenchmarkShared<SlistLock>>;
-    // using Runner4 = benchmark::Runner<SlistLock, shuffling::WeakShuffle, benchmark::BenchmarkShared<SlistLock>>;
+    std::vector<std::string> split(const std::string &s) {
+        std::vector<std::string> parts;
+        std::stringstream stream(s);
+        std::string part;
+        while(std::getline(stream, part, ',')) {
+            if(!part.empty()) parts.push_back(part);
+        }
+        return parts;
+    }
 
-    // using Runner5 = benchmark::Runner<SlistLock2, shuffling::Permutation, benchmark::BenchmarkDisjoint<SlistLock2>>;
-    // using Runner6 = benchmark::Runner<SlistLock2, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SlistLock2>>;
-    // using Runner7 = benchmark::Runner<SlistLock2, shuffling::Permutation, benchmark::BenchmarkShared<SlistLock2>>;
-    // using Runner8 = benchmark::Runner<SlistLock2, shuffling::WeakShuffle, benchmark::BenchmarkShared<SlistLock2>>;
+    //comma separated, lo-hi is an inclusive range
+    std::vector<int> parse_ints(const std::string &s) {
+        std::vector<int> values;
+        for(auto &part : split(s)) {
+            size_t dash = part.find('-', 1);
+            if(dash == std::string::npos) {
+                values.push_back(std::stoi(part));
+                continue;
+            }
+            int lo = std::stoi(part.substr(0, dash)), hi = std::stoi(part.substr(dash + 1));
+            for(int x = lo; x <= hi; ++x) values.push_back(x);
+        }
+        return values;
+    }
 
-    // using Runner9  = benchmark::Runner<SlistLock3, shuffling::Permutation, benchmark::BenchmarkDisjoint<SlistLock3>>;
-    // using Runner10 = benchmark::Runner<SlistLock3, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SlistLock3>>;
-    // using Runner11 = benchmark::Runner<SlistLock3, shuffling::Permutation, benchmark::BenchmarkShared<SlistLock3>>;
-    // using Runner12 = benchmark::Runner<SlistLock3, shuffling::WeakShuffle, benchmark::BenchmarkShared<SlistLock3>>;
+    std::vector<double> parse_doubles(const std::string &s) {
+        std::vector<double> values;
+        for(auto &part : split(s)) values.push_back(std::stod(part));
+        return values;
+    }
 
-    // using Runner13 = benchmark::Runner<SlistLock4, shuffling::Permutation, benchmark::BenchmarkDisjoint<SlistLock4>>;
-    // using Runner14 = benchmark::Runner<SlistLock4, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SlistLock4>>;
-    // using Runner15 = benchmark::Runner<SlistLock4, shuffling::Permutation, benchmark::BenchmarkShared<SlistLock4>>;
-    // using Runner16 = benchmark::Runner<SlistLock4, shuffling::WeakShuffle, benchmark::BenchmarkShared<SlistLock4>>;
+    enum class Mode { time, metric, latency, counters };
+
+    template<class Slist, class Benchmark, Mode mode>
+    void run_shuffled(Config &c, std::ofstream &file, std::vector<int> &ts, std::string &variant) {
+        constexpr bool time_bounded = requires(Benchmark b, Slist &s, std::vector<int_type> &v) { b.run_with_ops(s, v); };
+        auto run = [&]<class Runner>() {
+            if constexpr(mode == Mode::metric) printer::run_special_metric<Runner>(file, c.it, ts, c.ps, c.max_levels, c.ns, c.shuffle, c.label, variant);
+            else if constexpr(mode == Mode::latency) printer::run_latency<Runner>(file, c.it, ts, c.ps, c.max_levels, c.ns, c.shuffle, c.label, variant);
+            else if constexpr(mode == Mode::counters) printer::run_counters<Runner>(file, c.it, ts, c.ps, c.max_levels, c.ns, c.shuffle, c.label, variant);
+            else if constexpr(time_bounded) printer::run_throughput<Runner>(file, c.it, ts, c.ps, c.max_levels, c.ns, c.shuffle, c.label, variant);
+            else printer::run_benchmark<Runner>(file, c.it, ts, c.ps, c.max_levels, c.ns, c.shuffle, c.label, variant);
+        };
+        if(c.shuffle == "permutation") {
+            run.template operator()<benchmark::Runner<Slist, shuffling::Permutation, Benchmark>>();
+        }
+        else {
+            run.template operator()<benchmark::Runner<Slist, shuffling::WeakShuffle, Benchmark>>();
+        }
+    }
 
+    //operations a variant offers, decide which workloads it can run
+    template<class Slist>
+    struct Traits {
+        static constexpr bool is_set = requires(Slist &s, int_type k) { s.search(k); s.remove(k); };
+        static constexpr bool batches = requires(Slist &s, std::vector<std::pair<int_type, int_type>> &r) { s.insert_batch(r.begin(), r.end()); };
+        static constexpr bool pops = requires(Slist &s) { s.pop_min(); };
+        static constexpr bool pop_batches = requires(Slist &s) { s.pop_batch(); };
+        static constexpr bool scans = requires(Slist &s, int_type k) { s.lower_bound(k).valid(); };
+    };
 
-    std::string permuation = "permutation";
-    std::string weak_shuffle = "weak_shuffle";
+    template<class Slist>
+    std::vector<std::string> workloads() {
+        using T = Traits<Slist>;
+        std::vector<std::string> names;
+        if constexpr(T::is_set) names.insert(names.end(), {"disjoint", "shared", "ingest", "ycsb"});
+        if constexpr(T::batches) names.push_back("ingest_batched");
+        if constexpr(T::pops) names.push_back("pop");
+        if constexpr(T::pop_batches) names.insert(names.end(), {"pop_batched", "spray"});
+        return names;
+    }
 
-    std::string shared = "shared";
-    std::string disjoint = "disjoint";
-    
-    std::string lock = "lock";
-    std::string lockless = "lockless";
-    std::string lock_shared_ptr = "lock_shared_ptr";
-    std::string sequential = "sequential";
+    //maps the workload name to a benchmark the variant supports, false if it supports none
+    //latency is only recorded by the disjoint, shared and ycsb workloads, metric needs a counting build
+    template<class Slist, Mode mode>
+    bool run_workload(Config &c, std::ofstream &file, std::vector<int> &ts, std::string &variant) {
+        constexpr bool is_set = Traits<Slist>::is_set;
+        constexpr bool batches = Traits<Slist>::batches && mode != Mode::latency;
+        constexpr bool pops = Traits<Slist>::pops && (mode == Mode::time || mode == Mode::counters);
+        constexpr bool pop_batches = Traits<Slist>::pop_batches && (mode == Mode::time || mode == Mode::counters);
+        auto run = [&]<class Benchmark>() {
+            run_shuffled<Slist, Benchmark, mode>(c, file, ts, variant);
+            return true;
+        };
+        if constexpr(is_set) {
+            if(c.workload == "disjoint") return run.template operator()<benchmark::BenchmarkDisjoint<Slist>>();
+            if(c.workload == "shared") return run.template operator()<benchmark::BenchmarkShared<Slist>>();
+        }
+        if constexpr(is_set && mode != Mode::latency) {
+            if(c.workload == "ingest") return run.template operator()<benchmark::BenchmarkIngest<Slist, false>>();
+        }
+        if constexpr(is_set && mode != Mode::metric) {
+            if(c.workload == "ycsb" && (c.ycsb.scan == 0 || Traits<Slist>::scans)) return run.template operator()<benchmark::BenchmarkYcsb<Slist>>();
+        }
+        if constexpr(batches) {
+            if(c.workload == "ingest_batched") return run.template operator()<benchmark::BenchmarkIngest<Slist, true>>();
+        }
+        if constexpr(pops) {
+            if(c.workload == "pop") return run.template operator()<benchmark::BenchmarkPriorityQueue<Slist>>();
+        }
+        if constexpr(pop_batches) {
+            if(c.workload == "pop_batched") return run.template operator()<benchmark::BenchmarkPriorityQueue<Slist, queueing::Batched>>();
+            if(c.workload == "spray") return run.template operator()<benchmark::BenchmarkPriorityQueue<Slist, queueing::Spray>>();
+        }
+        return false;
+    }
 
-    std::vector<int> all_threads = {1,2,3,4,5,6,7,8,9,10,11,12}; 
-    std::vector<int> half_threads = {1,2,3,4,5,6}; 
-    std::vector<int> one_thread = {1}; 
-    std::vector<int> default_thread = {6}; 
-    std::vector<int> max_thread = {12}; 
+    //one entry per benchmarked type, sequential variants always run with a single thread
+    struct Variant {
+        std::string name;
+        bool (*run)(Config&, std::ofstream&, std::vector<int>&, std::string&);
+        bool (*run_metric)(Config&, std::ofstream&, std::vector<int>&, std::string&); //only variants with do_count
+        bool (*run_latency)(Config&, std::ofstream&, std::vector<int>&, std::string&);
+        bool (*run_counters)(Config&, std::ofstream&, std::vector<int>&, std::string&);
+        std::vector<std::string> workloads;
+        bool sequential = false;
+        bool scans = false; //ycsb mixes with scans need lower_bound
+    };
 
-    std::vector<int> default_max_lv = {32}; 
+    template<class Slist, class CountingSlist = void>
+    Variant entry(std::string name, bool sequential = false) {
+        Variant v{name, &run_workload<Slist, Mode::time>, nullptr, &run_workload<Slist, Mode::latency>, &run_workload<Slist, Mode::counters>, workloads<Slist>(), sequential, Traits<Slist>::scans};
+        if constexpr(!std::is_void_v<CountingSlist>) v.run_metric = &run_workload<CountingSlist, Mode::metric>;
+        return v;
+    }
 
-    std::vector<double> default_p = {0.5}; 
-    
+    std::vector<Variant>& registry() {
+        static std::vector<Variant> variants = {
+            entry<LockSkipList<int_type, int_type>, LockSkipList<int_type, int_type, true>>("lock"),
+            entry<LockFreeSkipList<int_type, int_type>, LockFreeSkipList<int_type, int_type, true>>("lockless"),
+            entry<LockSkipList2<int_type, int_type>>("lock_shared_ptr"), //with shared ptr
+            entry<SeqSkipList<int_type, int_type>>("sequential", true),
+            entry<IndexableSeqSkipList<int_type, int_type>>("sequential_indexable", true),
+            entry<IndexableLockSkipList<int_type, int_type>>("lock_indexable"),
+            //reclamation, lock and lockless use the default policies (queues and epochs)
+            entry<LockSkipList<int_type, int_type, false, reclamation::EpochBased>>("lock_epoch"),
+            entry<LockSkipList<int_type, int_type, false, reclamation::HazardPointers>>("lock_hazard"),
+            entry<LockFreeSkipList<int_type, int_type, false, reclamation::GarbageQueues>>("lockless_queues"),
+            entry<LockFreeSkipList<int_type, int_type, false, reclamation::HazardPointers>>("lockless_hazard"),
+            //unrolled blocks
+            entry<UnrolledLockSkipList<int_type, int_type>>("lock_unrolled"),
+            entry<UnrolledLockSkipList<int_type, int_type, 32>>("lock_unrolled32"),
+            //node lock policies
+            entry<LockSkipList<int_type, int_type, false, reclamation::GarbageQueues, 64, lock::BackoffSpinlock<>>>("lock_backoff"),
+            entry<LockSkipList<int_type, int_type, false, reclamation::GarbageQueues, 64, lock::BackoffSpinlock<true>>>("lock_park"),
+            entry<LockSkipList<int_type, int_type, false, reclamation::GarbageQueues, 64, lock::MCSLock>>("lock_mcs"),
+            entry<LockSkipList<int_type, int_type, false, reclamation::GarbageQueues, 64, std::mutex>>("lock_mutex"),
+            entry<UnrolledLockSkipList<int_type, int_type, 16, reclamation::GarbageQueues, 64, lock::BackoffSpinlock<>>>("lock_unrolled_backoff"),
+            entry<UnrolledLockSkipList<int_type, int_type, 16, reclamation::GarbageQueues, 64, lock::BackoffSpinlock<true>>>("lock_unrolled_park"),
+            entry<UnrolledLockSkipList<int_type, int_type, 16, reclamation::GarbageQueues, 64, lock::MCSLock>>("lock_unrolled_mcs"),
+            entry<UnrolledLockSkipList<int_type, int_type, 16, reclamation::GarbageQueues, 64, std::mutex>>("lock_unrolled_mutex"),
+            //baseline for the pop workloads
+            entry<queueing::MutexPriorityQueue<int_type, int_type>>("priority_queue"),
+        };
+        return variants;
+    }
 
-    int it;
-    std::vector<double> ps;
-    std::vector<int> max_levels, ns, ts;
-    std::string filename;
-    std::ofstream file;
-
-    /* vary p */
-    // filename = "vary_p.txt";
-    // file = std::ofstream(filename);
-    // printer::print_headline(file);
-    // it = 5;
-    // ps.clear();
-    // for(double d = 0.05; d <= 0.80; d += 0.025) ps.push_back(d);
-    // max_levels = default_max_lv;
-    // ns = {1000000};
-    // ts = default_thread;
-    /* vary p */
-
-    /* scaling */
-    // filename = "scaling.txt";
-    // file = std::ofstream(filename);
-    // printer::print_headline(file);
-    // it = 5;
-    // ps = default_p;
-    // max_levels = default_max_lv; 
-    // ns = {100000, 1000000};
-    // ts = all_threads;
-    // ts = {9,10,11,12};
-    /* scaling */
-
-    /* vary n */
-    // filename = "vary_n.txt";
-    // file = std::ofstream(filename);
-    // printer::print_headline(file);
-    // it = 5;
-    // ps = default_p;
-    // max_levels = default_max_lv; 
-    // ns.clear();
-    // for(int i = 2; i <= 1 << 22; i *= 2) ns.push_back(i);
-    // ts = {6,12};
-    /* vary n */
-
-    // printer::run_benchmark<Runner1>(file, it, ts, ps, max_levels, ns, permuation, disjoint, lock);
-    // printer::run_benchmark<Runner2>(file, it, ts, ps, max_levels, ns, weak_shuffle, disjoint, lock);
-    // printer::run_benchmark<Runner3>(file, it, ts, ps, max_levels, ns, permuation, shared, lock);
-    // printer::run_benchmark<Runner4>(file, it, ts, ps, max_levels, ns, weak_shuffle, shared, lock);
-
-    // printer::run_benchmark<Runner5>(file, it, ts, ps, max_levels, ns, permuation, disjoint, lockless);
-    // printer::run_benchmark<Runner6>(file, it, ts, ps, max_levels, ns, weak_shuffle, disjoint, lockless);
-    // printer::run_benchmark<Runner7>(file, it, ts, ps, max_levels, ns, permuation, shared, lockless);
-    // printer::run_benchmark<Runner8>(file, it, ts, ps, max_levels, ns, weak_shuffle, shared, lockless);
-
-    // printer::run_benchmark<Runner9>(file, it, ts, ps, max_levels, ns, permuation, disjoint, lock_shared_ptr);
-    // printer::run_benchmark<Runner10>(file, it, ts, ps, max_levels, ns, weak_shuffle, disjoint, lock_shared_ptr);
-    // printer::run_benchmark<Runner11>(file, it, ts, ps, max_levels, ns, permuation, shared, lock_shared_ptr);
-    // printer::run_benchmark<Runner12>(file, it, ts, ps, max_levels, ns, weak_shuffle, shared, lock_shared_ptr);
-
-    // printer::run_benchmark<Runner13>(file, it, one_thread, ps, max_levels, ns, permuation, disjoint, sequential);
-    // printer::run_benchmark<Runner14>(file, it, one_thread, ps, max_levels, ns, weak_shuffle, disjoint, sequential);
-    // printer::run_benchmark<Runner15>(file, it, one_thread, ps, max_levels, ns, permuation, shared, sequential);
-    // printer::run_benchmark<Runner16>(file, it, one_thread, ps, max_levels, ns, weak_shuffle, shared, sequential);
-
-
-    /* special metric */
-    // using SSlistLock = LockSkipList<int_type, int_type, true>;
-    // using SSlistLock2 = LockFreeSkipList<int_type, int_type, true>;
-
-    // using SRunner1 = benchmark::Runner<SSlistLock, shuffling::Permutation, benchmark::BenchmarkDisjoint<SSlistLock>>;
-    // using SRunner2 = benchmark::Runner<SSlistLock, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SSlistLock>>;
-    // using SRunner3 = benchmark::Runner<SSlistLock, shuffling::Permutation, benchmark::BenchmarkShared<SSlistLock>>;
-    // using SRunner4 = benchmark::Runner<SSlistLock, shuffling::WeakShuffle, benchmark::BenchmarkShared<SSlistLock>>;
-
-    // using SRunner5 = benchmark::Runner<SSlistLock2, shuffling::Permutation, benchmark::BenchmarkDisjoint<SSlistLock2>>;
-    // using SRunner6 = benchmark::Runner<SSlistLock2, shuffling::WeakShuffle, benchmark::BenchmarkDisjoint<SSlistLock2>>;
-    // using SRunner7 = benchmark::Runner<SSlistLock2, shuffling::Permutation, benchmark::BenchmarkShared<SSlistLock2>>;
-    // using SRunner8 = benchmark::Runner<SSlistLock2, shuffling::WeakShuffle, benchmark::BenchmarkShared<SSlistLock2>>;
-
-    /* counter */
-    // filename = "counter.txt";
-    // file = std::ofstream(filename);
-    // printer::print_headline2(file);
-    // it = 5;
-    // ps = default_p;
-    // max_levels = default_max_lv; 
-    // ns = {1000000};
-    // ts = {6,12};
-    /* counter */
-    // printer::run_special_metric<SRunner1>(file, it, ts, ps, max_levels, ns, permuation, disjoint, lock);
-    // printer::run_special_metric<SRunner2>(file, it, ts, ps, max_levels, ns, weak_shuffle, disjoint, lock);
-    // printer::run_special_metric<SRunner3>(file, it, ts, ps, max_levels, ns, permuation, shared, lock);
-    // printer::run_special_metric<SRunner4>(file, it, ts, ps, max_levels, ns, weak_shuffle, shared, lock);
-
-    // printer::run_special_metric<SRunner5>(file, it, ts, ps, max_levels, ns, permuation, disjoint, lockless);
-    // printer::run_special_metric<SRunner6>(file, it, ts, ps, max_levels, ns, weak_shuffle, disjoint, lockless);
-    // printer::run_special_metric<SRunner7>(file, it, ts, ps, max_levels, ns, permuation, shared, lockless);
-    // printer::run_special_metric<SRunner8>(file, it, ts, ps, max_levels, ns, weak_shuffle, shared, lockless);
-    /* special metric */
-    
+    //rank queries on the indexable skiplist against a sorted vector, variants are the index refresh or the sorter
+    bool run_rank(Config &c, std::ofstream &file, std::string &variant) {
+        for(auto &n : c.ns) {
+            for(auto &sections : c.sections) {
+                if(variant == "indexable_slist") printer::run_index_benchmark<shuffling::Permutation>(file, c.it, n, sections, c.ts, c.shuffle);
+                else if(variant == "indexable_slist_par") printer::run_index_benchmark<shuffling::Permutation, indexing::Parallel>(file, c.it, n, sections, c.ts, c.shuffle);
+                else if(variant == "indexable_slist_incremental") printer::run_index_benchmark<shuffling::Permutation, indexing::Incremental>(file, c.it, n, sections, c.ts, c.shuffle);
+                else if(variant == "vector_seq" || variant == "vector_par") {
+                    for(int i = 1; i <= c.it; ++i) {
+                        bool weak = c.shuffle == "weak_shuffle";
+                        bool seq = variant == "vector_seq";
+                        if(seq && !weak) printer::run_vector_benchmark<shuffling::Permutation, printer::SeqSorter>(file, i, n, sections, c.ts, c.shuffle, variant);
+                        if(seq && weak) printer::run_vector_benchmark<shuffling::WeakShuffle, printer::SeqSorter>(file, i, n, sections, c.ts, c.shuffle, variant);
+                        if(!seq && !weak) printer::run_vector_benchmark<shuffling::Permutation, printer::ParSorter>(file, i, n, sections, c.ts, c.shuffle, variant);
+                        if(!seq && weak) printer::run_vector_benchmark<shuffling::WeakShuffle, printer::ParSorter>(file, i, n, sections, c.ts, c.shuffle, variant);
+                    }
+                }
+                else return false;
+            }
+        }
+        return true;
+    }
 
-    /* rank */
-    std::string seq_vec = "vector_seq";
-    std::string par_vec = "vector_par";
-    filename = "rank.txt";
-    file = std::ofstream(filename);
-    printer::print_headline3(file);
-    it = 5;
-    int n1 = 100000; 
-    ts = all_threads;
-    std::vector<uint> sec = {1, 10, 100, 1000};
+    void usage(std::ostream &out) {
+        out << "usage: time [options]\n"
+            << "  --variant v1,v2|all   skiplist variants (default lock)\n"
+            << "  --workload w          disjoint, shared, ingest, ingest_batched, pop, pop_batched, spray, ycsb or rank (default disjoint)\n"
+            << "  --shuffle s           permutation or weak_shuffle (default permutation)\n"
+            << "  --n n1,n2             number of elements (default 1000000)\n"
+            << "  --p p1,p2             level probabilities (default 0.5)\n"
+            << "  --max-level l1,l2     max levels (default 32)\n"
+            << "  --threads t1,t2|lo-hi thread counts (default 1-12)\n"
+            << "  --sections s1,s2      insert/query rounds of the rank workload (default 1,10,100,1000)\n"
+            << "  --it i                iterations per configuration (default 5)\n"
+            << "  --out file            result table (default benchmark.txt)\n"
+            << "  --metric              count searches and retries, variants lock and lockless\n"
+            << "  --latency             p50, p99 and p99.9 per operation in ns, workloads disjoint, shared and ycsb\n"
+            << "  --counters            cycles, instructions, l1d, llc and dtlb misses and branch misses per operation (perf_event_open)\n"
+            << "  --pin policy          none, compact, scatter, cores or numa thread placement from sysfs (default none)\n"
+            << "ycsb workload, --n keys are loaded before a time bounded run of the mix:\n"
+            << "  --ycsb a|b|c|d|e|f    core workload preset, implies --workload ycsb\n"
+            << "  --mix read=r,update=u,insert=i,remove=d,scan=s  operation ratios (default read=0.95,update=0.05)\n"
+            << "  --distribution d      uniform, zipfian, hotspot or latest (default zipfian)\n"
+            << "  --theta t             zipfian skew in (0, 1) (default 0.99)\n"
+            << "  --hotspot set,ops     fraction of hot keys and of operations on them (default 0.2,0.8)\n"
+            << "  --scan-length l       keys per scan (default 100)\n"
+            << "  --duration s          seconds of steady state (default 1)\n"
+            << "  --list                print the variants and the workloads they support\n"
+            << "all runs every variant that supports the workload\n";
+    }
 
-    //1 thread, 6 threads, 12 threads
+    void list(std::ostream &out) {
+        for(auto &v : registry()) {
+            out << v.name << ":";
+            for(auto &w : v.workloads) out << " " << w;
+            out << (v.run_metric != nullptr ? " (--metric)" : "") << (v.sequential ? " (one thread)" : "") << "\n";
+        }
+        out << "indexable_slist indexable_slist_par indexable_slist_incremental vector_seq vector_par: rank\n";
+    }
 
-    //after that with fixed thread and varying section
-    for(auto &sections : sec) {
-        // printer::run_index_benchmark<shuffling::Permutation>(file, it, n1, sections, ts, permuation);
-        // printer::run_index_benchmark<shuffling::WeakShuffle>(file, it, n1, sections, ts, weak_shuffle);
+    //name=ratio pairs, missing operations get ratio 0
+    void parse_mix(ycsb::Spec &s, const std::string &value) {
+        s.read = s.update = s.insert = s.remove = s.scan = 0;
+        for(auto &part : split(value)) {
+            size_t eq = part.find('=');
+            if(eq == std::string::npos) throw ArgumentError("--mix needs name=ratio pairs");
+            std::string name = part.substr(0, eq);
+            double ratio = std::stod(part.substr(eq + 1));
+            if(name == "read") s.read = ratio;
+            else if(name == "update") s.update = ratio;
+            else if(name == "insert") s.insert = ratio;
+            else if(name == "remove") s.remove = ratio;
+            else if(name == "scan") s.scan = ratio;
+            else throw ArgumentError("unknown operation " + name);
+        }
+    }
 
-        for(int i = 1; i <= it; ++i) {
-            printer::run_vector_benchmark<shuffling::Permutation, printer::SeqSorter>(file, i, n1, sections, ts, permuation, seq_vec);
+    //throws ArgumentError on unknown options or malformed values
+    Config parse(int argc, char **argv) {
+        Config c;
+        for(int i = 1; i < argc; ++i) {
+            std::string flag = argv[i];
+            if(flag == "--metric" || flag == "--latency" || flag == "--counters" || flag == "--list" || flag == "--help") {
+                (flag == "--metric" ? c.metric : flag == "--latency" ? c.latency : flag == "--counters" ? c.counters : flag == "--list" ? c.list : c.help) = true;
+                continue;
+            }
+            std::function<void(const std::string&)> set;
+            if(flag == "--variant") set = [&](auto &v) { c.variants = split(v); };
+            else if(flag == "--workload") set = [&](auto &v) { c.workload = v; };
+            else if(flag == "--shuffle") set = [&](auto &v) { c.shuffle = v; };
+            else if(flag == "--n") set = [&](auto &v) { c.ns = parse_ints(v); };
+            else if(flag == "--p") set = [&](auto &v) { c.ps = parse_doubles(v); };
+            else if(flag == "--max-level") set = [&](auto &v) { c.max_levels = parse_ints(v); };
+            else if(flag == "--threads") set = [&](auto &v) { c.ts = parse_ints(v); };
+            else if(flag == "--sections") set = [&](auto &v) { c.sections = parse_ints(v); };
+            else if(flag == "--it") set = [&](auto &v) { c.it = std::stoi(v); };
+            else if(flag == "--out") set = [&](auto &v) { c.out = v; };
+            else if(flag == "--pin") set = [&](auto &v) { c.pin = v; };
+            else if(flag == "--ycsb") set = [&](auto &v) {
+                if(!ycsb::preset(c.ycsb, v)) throw ArgumentError("unknown ycsb preset " + v);
+                c.workload = "ycsb";
+            };
+            else if(flag == "--mix") set = [&](auto &v) { parse_mix(c.ycsb, v); };
+            else if(flag == "--distribution") set = [&](auto &v) { c.ycsb.distribution = v; };
+            else if(flag == "--theta") set = [&](auto &v) { c.ycsb.theta = std::stod(v); };
+            else if(flag == "--hotspot") set = [&](auto &v) {
+                auto fractions = parse_doubles(v);
+                if(fractions.size() != 2) throw ArgumentError("--hotspot needs set,ops");
+                c.ycsb.hot_set = fractions[0];
+                c.ycsb.hot_ops = fractions[1];
+            };
+            else if(flag == "--scan-length") set = [&](auto &v) { c.ycsb.scan_length = std::stoi(v); };
+            else if(flag == "--duration") set = [&](auto &v) { c.ycsb.duration = std::stod(v); };
+            else throw ArgumentError("unknown option " + flag);
+            if(i + 1 >= argc) throw ArgumentError("missing value for " + flag);
+            std::string value = argv[++i];
+            try {
+                set(value);
+            }
+            catch(const ArgumentError &) {
+                throw;
+            }
+            catch(const std::logic_error &) { //stoi and stod throw invalid_argument or out_of_range
+                throw ArgumentError("malformed value " + value + " for " + flag);
+            }
         }
-        for(int i = 1; i <= it; ++i) {
-            printer::run_vector_benchmark<shuffling::WeakShuffle, printer::SeqSorter>(file, i, n1, sections, ts, weak_shuffle, seq_vec);
+        if(c.shuffle != "permutation" && c.shuffle != "weak_shuffle") throw ArgumentError("unknown shuffle " + c.shuffle);
+        if(std::find(placement::policies.begin(), placement::policies.end(), c.pin) == placement::policies.end()) throw ArgumentError("unknown pin policy " + c.pin);
+        if(c.metric + c.latency + c.counters > 1) throw ArgumentError("--metric, --latency and --counters can not be combined");
+        if(c.counters && c.workload == "rank") throw ArgumentError("--counters does not support workload rank");
+        if(c.latency && c.workload != "disjoint" && c.workload != "shared" && c.workload != "ycsb") throw ArgumentError("--latency needs workload disjoint, shared or ycsb");
+        if(c.metric && c.workload == "ycsb") throw ArgumentError("--metric does not support workload ycsb");
+        c.label = c.workload;
+        if(c.workload == "ycsb") {
+            ycsb::validate(c.ycsb);
+            c.label = "ycsb_" + c.ycsb.distribution;
+        }
+        if(c.variants.size() == 1 && c.variants[0] == "all") {
+            c.variants.clear();
+            for(auto &v : registry()) {
+                bool supported = std::find(v.workloads.begin(), v.workloads.end(), c.workload) != v.workloads.end();
+                supported &= c.workload != "ycsb" || c.ycsb.scan == 0 || v.scans;
+                if(supported && (!c.metric || v.run_metric != nullptr)) c.variants.push_back(v.name);
+            }
+        }
+        return c;
+    }
+}
+/* driver */
+
+//sweeps are chosen on the command line, see driver::usage, e.g.
+//  time --variant lock,lockless --workload shared --threads 1-12
+//  time --variant lock --p 0.05,0.1,0.25,0.5,0.75 --threads 6 --out vary_p.txt
+//  time --variant lock,lock_backoff,lock_park,lock_mcs,lock_mutex --workload shared --threads 1,2,4,8,16,32,64
+//  time --variant lock_unrolled,lock_unrolled_backoff,lock_unrolled_park,lock_unrolled_mcs,lock_unrolled_mutex --workload shared --threads 1,2,4,8,16,32,64
+//  time --variant lock,lockless --workload shared --pin scatter --threads 1-48
+//  time --variant vector_seq,indexable_slist --workload rank --n 100000
+int main(int argc, char **argv)
+{
+    driver::Config config;
+    try {
+        config = driver::parse(argc, argv);
+    }
+    catch(const std::exception &e) {
+        std::cerr << e.what() << "\n";
+        driver::usage(std::cerr);
+        return 1;
+    }
+    if(config.help) {
+        driver::usage(std::cout);
+        return 0;
+    }
+    if(config.list) {
+        driver::list(std::cout);
+        return 0;
+    }
+
+    std::ofstream file(config.out);
+    if(config.workload == "rank") printer::print_headline3(file);
+    else if(config.metric) printer::print_headline2(file);
+    else if(config.latency) printer::print_headline4(file);
+    else if(config.counters) printer::print_headline6(file);
+    else if(config.workload == "ycsb") printer::print_headline5(file);
+    else printer::print_headline(file);
+    ycsb::spec() = config.ycsb;
+    placement::policy() = config.pin;
+    if(config.workload != "rank") printer::print_placement(file, config.ts);
+
+    std::vector<int> one_thread = {1};
+    bool ok = true;
+    for(auto &name : config.variants) {
+        if(config.workload == "rank") {
+            if(!driver::run_rank(config, file, name)) {
+                std::cerr << "unknown rank variant " << name << "\n";
+                ok = false;
+            }
+            continue;
         }
-        for(int i = 1; i <= it; ++i) {
-            printer::run_vector_benchmark<shuffling::Permutation, printer::ParSorter>(file, i, n1, sections, ts, permuation, par_vec);
+        auto &variants = driver::registry();
+        auto v = std::find_if(variants.begin(), variants.end(), [&](auto &e) { return e.name == name; });
+        if(v == variants.end()) {
+            std::cerr << "unknown variant " << name << "\n";
+            ok = false;
+            continue;
         }
-        for(int i = 1; i <= it; ++i) {
-            printer::run_vector_benchmark<shuffling::WeakShuffle, printer::ParSorter>(file, i, n1, sections, ts, weak_shuffle, par_vec);
+        auto &ts = v -> sequential ? one_thread : config.ts;
+        bool ran;
+        if(config.metric) ran = v -> run_metric != nullptr && v -> run_metric(config, file, ts, name);
+        else if(config.latency) ran = v -> run_latency(config, file, ts, name);
+        else if(config.counters) ran = v -> run_counters(config, file, ts, name);
+        else ran = v -> run(config, file, ts, name);
+        if(!ran) {
+            std::cerr << "variant " << name << " does not support workload " << config.workload << (config.metric ? " with --metric" : "") << "\n";
+            ok = false;
         }
-        // printer::run_vector_benchmark<shuffling::Permutation, printer::SeqSorter>(file, it, n1, sections, ts, permuation, seq_vec);
-        // printer::run_vector_benchmark<shuffling::WeakShuffle, printer::SeqSorter>(file, it, n1, sections, ts, weak_shuffle, seq_vec);
-        // printer::run_vector_benchmark<shuffling::Permutation, printer::ParSorter>(file, it, n1, sections, ts, permuation, par_vec);
-        // printer::run_vector_benchmark<shuffling::WeakShuffle, printer::ParSorter>(file, it, n1, sections, ts, weak_shuffle, par_vec);
     }
-    /* rank */
-    return 0;
+    return ok ? 0 : 1;
 }